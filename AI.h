@@ -2,13 +2,35 @@
 #define AI_H
 
 #include "Timer.h"
+#include "move.h"
 #include "boop.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <mutex>
 #include <queue>
 #include <string>
+#include <thread>
+#include <typeinfo>
 
 class Boop;
 
+// What one think searched, for AIs that report it
+struct Search_Stats {
+    long long nodes = 0;                // Positions visited
+    long long leaf_evaluations = 0;     // Positions scored at the search horizon or the end of the game (or playouts)
+    long long beta_cutoffs = 0;         // Nodes where a move was good enough to skip the rest
+    long long first_move_cutoffs = 0;   // Cutoffs caused by the first move searched
+    int depth = 0;                      // The deepest search that finished
+    double branching_factor = 0;        // Effective branching factor, 0 if not measured
+    bool timed_out = false;             // The timer ran out partway through a search
+    bool book_move = false;             // The move came from an opening book, nothing was searched
+    bool has_score = false;             // The search finished an iteration and score holds its result
+    int score = 0;                      // The best move's score for the side that moved
+};
+
 class AI {
     public:
         // Constructor & Deconstructor
@@ -16,15 +38,48 @@ class AI {
 
         virtual ~AI() { }
 
-        /// Completely Virtual Functions
+        /// Virtual Functions, THE MOVE THINK FUNCTION MUST BE IMPLEMENTED (or derive from String_AI for strings)
         /**
-         * @brief Decides what move the AI wants to make, MUST BE IMPLEMENTED
+         * @brief Decides what move the AI wants to make, by default translating the moves for the Move version
          * @param moves A queue of all the possible legal moves
          * @param timer A timer object to keep track of how much time your AI has left to think.
          *              Use the "timer.times_up()" function to check if your AI is out of time
          * @return Returns the string of the desired move the AI wants to make to the Boop game
         */
-        virtual std::string think(std::queue<std::string> moves, Timer& timer) = 0;
+        virtual std::string think(std::queue<std::string> moves, Timer& timer);
+
+        /**
+         * @brief Decides what move the AI wants to make, without any strings or heap allocations
+         * @param moves A list of all the possible legal moves
+         * @param timer A timer object to keep track of how much time your AI has left to think.
+         *              Use the "timer.times_up()" function to check if your AI is out of time
+         * @return Returns the desired move the AI wants to make to the Boop game
+        */
+        virtual Move think(const MoveList& moves, Timer& timer) = 0;
+
+        /**
+         * @brief Reports what the last think searched, AIs that search can override this
+         * @param stats Filled in with the statistics of the last think
+         * @return A bool indicating if the AI reports statistics
+        */
+        virtual bool search_stats(Search_Stats& stats) const { return false; }
+
+        /**
+         * @brief A name for the AI in game records, the class name unless overridden
+        */
+        virtual std::string name() const {
+            int status;
+            char* demangled = abi::__cxa_demangle(typeid(*this).name(), nullptr, nullptr, &status);
+            std::string result = status == 0 ? demangled : typeid(*this).name();
+            free(demangled);
+            return result;
+        }
+
+        /**
+         * @brief The best move published during the current think, Boop plays it if think does not return in time
+         * @return The move, or an empty Move if none has been published
+        */
+        Move published_move() const { return Move::from_raw(published.load(std::memory_order_relaxed)); }
 
         /// Internal Boop Usage Only
         /**
@@ -33,9 +88,134 @@ class AI {
         */
         void set_game(Boop* game) { this->game = game; }
 
+        /**
+         * @brief Forgets the published move, called before each think
+        */
+        void clear_published() { published.store(0, std::memory_order_relaxed); }
+
     protected:
         // Game reference available to use provied helper functions
         const Boop* game = nullptr;
+
+        /**
+         * @brief Offers a move to play if think is still running at the deadline, call it whenever a better move is found
+         * @param move A legal move for the current position
+        */
+        void publish(Move move) { published.store(move.raw(), std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint16_t> published{0};
+};
+
+/**
+ * Runs an AI's thinks on a thread of their own, so the game can move on at the deadline whether or not
+ * think has returned. A think that is still running is cancelled through its timer, and has to return
+ * before the worker can start another one.
+ *
+ * Internal Boop Usage Only
+*/
+class Think_Worker {
+    public:
+        explicit Think_Worker(double think_ms) : timer(think_ms) { }
+        ~Think_Worker() { finish(); }
+
+        Think_Worker(const Think_Worker&) = delete;
+        Think_Worker& operator = (const Think_Worker&) = delete;
+
+        /**
+         * @brief Starts a think on the worker thread
+         * @param ai The AI to think, its game must not change until the think returns
+         * @param moves The legal moves, copied so the caller's list can go away
+        */
+        void start(AI* ai, const MoveList& moves) {
+            finish();
+            this->moves = moves;
+            done = false;
+            ai->clear_published();
+            start_time_point = steady_clock::now();
+            timer.start();
+            worker = std::thread([this, ai] {
+                Move move = ai->think(this->moves, timer);
+                timer.stop();
+                std::lock_guard<std::mutex> lock(done_lock);
+                result = move;
+                done = true;
+                done_signal.notify_all();
+            });
+        }
+
+        /**
+         * @brief Waits for the think to return, but no longer than a time since it started
+         * @return A bool indicating if the think returned
+        */
+        bool wait(double ms_since_start) {
+            std::unique_lock<std::mutex> lock(done_lock);
+            auto until = start_time_point + duration_cast<steady_clock::duration>(duration<double, std::milli>(ms_since_start));
+            return done_signal.wait_until(lock, until, [this] { return done; });
+        }
+
+        // Asks the running think to stop, it sees times_up() from now on
+        void cancel() { timer.cancel(); }
+
+        // A think was started and has not returned yet
+        bool busy() {
+            std::lock_guard<std::mutex> lock(done_lock);
+            return worker.joinable() && !done;
+        }
+
+        // The move the last think returned, once it has
+        Move move() {
+            std::lock_guard<std::mutex> lock(done_lock);
+            return result;
+        }
+
+        // How long the current think has run, or how long the last one took once it has returned
+        double elapsedMilliseconds() {
+            std::lock_guard<std::mutex> lock(done_lock);
+            return done ? timer.elapsedMilliseconds() : duration<double, std::milli>(steady_clock::now() - start_time_point).count();
+        }
+
+        // Waits for the last think to return, however long it takes
+        void finish() {
+            if(worker.joinable()) { worker.join(); }
+        }
+
+    private:
+        Timer timer;
+        MoveList moves;
+        std::thread worker;
+        std::mutex done_lock;
+        std::condition_variable done_signal;
+        bool done = false;
+        Move result;
+        time_point<steady_clock> start_time_point;
 };
 
-#endif
\ No newline at end of file
+/**
+ * For AIs that think in move strings: they implement the string think, and the Move think translates for it
+*/
+class String_AI : public AI {
+    public:
+        std::string think(std::queue<std::string> moves, Timer& timer) override = 0;
+        Move think(const MoveList& moves, Timer& timer) override;
+};
+
+// Each think function translates the moves and calls the other one
+inline std::string AI::think(std::queue<std::string> moves, Timer& timer) {
+    MoveList list;
+    while(!moves.empty()) {
+        list.push(Move::from_string(moves.front()));
+        moves.pop();
+    }
+    return think(list, timer).to_string();
+}
+
+inline Move String_AI::think(const MoveList& moves, Timer& timer) {
+    std::queue<std::string> strings;
+    for(Move move : moves) {
+        strings.push(move.to_string());
+    }
+    return Move::from_string(think(strings, timer));
+}
+
+#endif
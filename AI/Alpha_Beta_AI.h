@@ -0,0 +1,524 @@
+#ifndef ALPHA_BETA_AI_H
+#define ALPHA_BETA_AI_H
+
+#include "../AI.h"
+#include "../opening_book.h"
+#include "../transposition_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+/**
+ * The Minimax + Alpha Beta Pruning search shared by the alpha beta AIs.
+ *      Searches with iterative deepening, one ply deeper at a time until the next iteration would not fit
+ *      in the time left, and plays the best move of the last finished iteration.
+ *      Every search result is kept in a transposition table, so positions reached through different
+ *      move orders are only searched once. Moves are tried hash move first, then forcing moves, then
+ *      killer moves, then by history, so most cutoffs come from the first move searched.
+ *      Moves that a symmetry of the root board turns into one another are only searched once.
+ *      With more than one thread, helper threads search the same root at staggered depths (Lazy SMP).
+ *      They only talk through the shared table, where each fills in results the others can use.
+ *      Given an opening book, positions in the book are played from it without searching.
+ *      An AI only has to provide how it scores the search horizon.
+*/
+
+class Alpha_Beta_AI : public AI {
+    public:
+        /**
+         * @param table_megabytes How much memory the transposition table may use
+        */
+        explicit Alpha_Beta_AI(size_t table_megabytes = 16) : table(table_megabytes), threads(1) { }
+        Move think(const MoveList& moves, Timer& timer) override;
+
+        /**
+         * @brief Caps how deep iterative deepening may go, searching to a fixed depth if there is time
+         * @param depth The deepest iteration to search
+        */
+        void set_max_depth(int depth) { max_depth = std::min(depth, MAX_DEPTH); }
+
+        /**
+         * @brief Sets how many threads search each move, the calling thread counts as one
+         * @param count The number of threads, at least 1
+        */
+        void set_threads(int count) { threads.resize(std::max(count, 1)); }
+        int thread_count() const { return threads.size(); }
+
+        /**
+         * @brief Plays book moves while the game is in the opening book, instead of searching
+         * @param book An open book, which may be shared by many AIs and threads, or nullptr to always search
+        */
+        void set_book(const Opening_Book* book) { this->book = book; }
+
+        /**
+         * @brief The score of the move the last think chose, from my point of view
+         * @return The score, or 0 if the last think did not search
+        */
+        int best_score() const { return last_best_score; }
+
+        /**
+         * @brief How often a cutoff came from the first move searched during the last think, a measure of move ordering
+         * @return A fraction from 0 to 1, or 0 if there were no cutoffs
+        */
+        double first_move_cutoff_rate() const;
+
+        /**
+         * @brief The depth of the last finished iteration of the last think, by whichever thread got deepest
+        */
+        int completed_depth() const { return last_completed_depth; }
+
+        /**
+         * @brief The number of positions searched during the last think, over all threads
+        */
+        long long nodes_searched() const;
+
+        bool search_stats(Search_Stats& stats) const override;
+
+    protected:
+        static const int MAX_DEPTH = 64;
+        int max_depth = MAX_DEPTH;
+        Timer* timer;
+        Boop::who me = Boop::NEUTRAL;
+        Transposition_Table table;
+        // Mixed into every table key. Leaf scores are from my point of view, and some AIs score leaves
+        // against the root board, so a table entry is only valid for the search that made it.
+        uint64_t key_salt = 0;
+
+        // Set by AIs that keep their own state along the search path, so the search calls made_move and unmade_move
+        bool track_moves = false;
+
+        /**
+         * @brief Scores a position at the search horizon or at the end of the game
+         * @param thread The index of the search thread, from 0 to thread_count() - 1
+         * @return Higher is better for me
+         * @note Called from every search thread at once, so it must not change the AI
+        */
+        virtual int leaf_score(const Position* position, int thread) const = 0;
+
+        /**
+         * @brief Called before each search, after me and key_salt are set
+         * @param root The position being searched
+        */
+        virtual void new_search(const Position& root) { }
+
+        /**
+         * @brief With track_moves set, called after each move a search thread makes and before it is taken back
+         * @param position The thread's position after the move
+         * @param undo What the move changed
+        */
+        virtual void made_move(int thread, const Position& position, const Position::Undo& undo) { }
+        virtual void unmade_move(int thread) { }
+
+    private:
+        static const uint64_t P2_SALT = 0x9E3779B97F4A7C15ULL;
+        static constexpr int UNSEARCHED = std::numeric_limits<int>::min();
+        static constexpr double MIN_BRANCHING = 2;
+        static constexpr double MAX_BRANCHING = 16;
+
+        // Ordering scores, each class of move always sorts ahead of the next
+        static const int HASH_MOVE_SCORE = 1 << 30;
+        static const int TACTICAL_SCORE = 1 << 29;
+        static const int KILLER_SCORE = 1 << 28;
+        static const int HISTORY_LIMIT = 1 << 20;
+
+        struct Root_Move {
+            Move move;
+            int score;
+        };
+
+        // Everything one thread changes while it searches, so threads only share the table.
+        // Killers are indexed by ply and history by side to move and Move::index().
+        struct Search_Thread {
+            int id = 0;
+            Position position;
+            Root_Move root[MoveList::CAPACITY];
+            int root_count = 0;
+            int iteration_depth = 0;
+            int completed_depth = 0;
+            Move best_move;
+            int best_score = 0;
+            Move killers[MAX_DEPTH + 1][2];
+            int history[2][Move::INDEX_COUNT] = {};
+            long long nodes = 0;
+            long long leaf_evaluations = 0;
+            long long cutoffs = 0;
+            long long first_move_cutoffs = 0;
+        };
+
+        std::vector<Search_Thread> threads; // threads[0] is the thread that called think
+        std::atomic<bool> stop{false};      // Set when the main thread is done, the helpers finish up
+        int last_completed_depth = 0;
+        double last_branching_factor = 0;   // b in N = b^d, for the main threads last finished iteration of N nodes
+        bool last_timed_out = false;        // The main thread stopped partway through an iteration
+        int last_best_score = 0;
+        const Opening_Book* book = nullptr;
+        uint64_t book_random = 0x426F6F70426F6F70ULL;
+        bool last_book_move = false;        // The last think played from the book
+
+        // Iterative deepening on the main thread, which owns the time management
+        void search_main(Search_Thread& thread);
+
+        // Iterative deepening on a helper thread, until the main thread stops
+        void search_helper(Search_Thread& thread);
+
+        /**
+         * @brief Searches every root move to the given depth, then sorts them best first
+         * @return A bool indicating if the iteration finished before the search was stopped
+        */
+        bool search_root(Search_Thread& thread, int depth);
+
+        int minimax_alpha_beta(Search_Thread& thread, int depth, int alpha, int beta);
+
+        // The main thread stops on the timer, the helpers stop when the main thread does
+        bool stopped(const Search_Thread& thread) const {
+            return thread.id == 0 ? timer->times_up() : stop.load(std::memory_order_relaxed);
+        }
+
+        // Scores every move for ordering, see the ordering scores above
+        void score_moves(const Search_Thread& thread, const MoveList& moves, int scores[], Move hash_move, int ply) const;
+
+        // Swaps the best scored move not yet searched into slot i and returns it
+        static Move pick_move(MoveList& moves, int scores[], int i);
+
+        // Remembers a quiet move that caused a cutoff, so it is tried early in sibling positions
+        void record_cutoff(Search_Thread& thread, Move move, int depth, int ply, int move_number);
+
+        // Makes and takes back a move on the thread's position, telling the AI when it tracks moves
+        Position::Undo make_move(Search_Thread& thread, Move move) {
+            Position::Undo undo = thread.position.make_move(move);
+            if(track_moves) { made_move(thread.id, thread.position, undo); }
+            return undo;
+        }
+        void unmake_move(Search_Thread& thread, const Position::Undo& undo) {
+            if(track_moves) { unmade_move(thread.id); }
+            thread.position.unmake_move(undo);
+        }
+};
+
+inline Move Alpha_Beta_AI::think(const MoveList& legal_moves, Timer& timer) {
+    this->timer = &timer;
+
+    // On a symmetric board, mirror images of a move lead to the same game, only one of them is searched
+    MoveList moves = legal_moves;
+    game->position().drop_symmetric_moves(moves);
+
+    me = game->next_mover();
+    key_salt = (me == Boop::P2 ? P2_SALT : 0);
+    table.new_search();
+    new_search(game->position());
+    last_completed_depth = 0;
+    last_branching_factor = 0;
+    last_timed_out = false;
+    last_best_score = 0;
+    last_book_move = false;
+
+    for(int i = 0; i < (int) threads.size(); ++i) {
+        Search_Thread& thread = threads[i];
+        thread.id = i;
+        // Search a single copy of the game state per thread, making and unmaking moves on it
+        thread.position = game->position();
+        thread.root_count = moves.size();
+        for(int j = 0; j < moves.size(); ++j) { thread.root[j] = { moves[j], 0 }; }
+        // Helpers start on a different root move, so they wander off into different parts of the tree
+        std::rotate(thread.root, thread.root + i % moves.size(), thread.root + moves.size());
+        thread.completed_depth = 0;
+        thread.best_move = thread.root[0].move;
+        thread.best_score = 0;
+
+        // Killers are relative to the root, history carries over but older results count for less
+        thread.nodes = 0;
+        thread.leaf_evaluations = 0;
+        thread.cutoffs = 0;
+        thread.first_move_cutoffs = 0;
+        for(auto& ply : thread.killers) { ply[0] = ply[1] = Move(); }
+        for(auto& side : thread.history) { for(int& score : side) { score /= 8; } }
+    }
+
+    if(moves.size() == 1) { return moves[0]; }
+
+    if(book != nullptr) {
+        book_random ^= book_random << 13;
+        book_random ^= book_random >> 7;
+        book_random ^= book_random << 17;
+        Move book_move = book->pick(game->position(), legal_moves, book_random);
+        if(book_move != Move()) {
+            last_book_move = true;
+            return book_move;
+        }
+    }
+
+    stop = false;
+    std::vector<std::thread> helpers;
+    for(size_t i = 1; i < threads.size(); ++i) {
+        helpers.emplace_back(&Alpha_Beta_AI::search_helper, this, std::ref(threads[i]));
+    }
+    search_main(threads[0]);
+    stop = true;
+    for(std::thread& helper : helpers) { helper.join(); }
+
+    // Play the move of whichever thread finished the deepest iteration, the main thread wins ties
+    const Search_Thread* deepest = &threads[0];
+    for(const Search_Thread& thread : threads) {
+        if(thread.completed_depth > deepest->completed_depth) { deepest = &thread; }
+    }
+    last_completed_depth = deepest->completed_depth;
+    last_best_score = deepest->best_score;
+    return deepest->best_move;
+}
+
+inline void Alpha_Beta_AI::search_main(Search_Thread& thread) {
+    // Search one ply deeper each iteration, the next iteration starts with this ones best moves
+    double last_iteration_ms = 0;
+    double previous_iteration_ms = 0;
+    for(int depth = 1; depth <= max_depth; ++depth) {
+        double started_ms = timer->elapsedMilliseconds();
+        long long started_nodes = thread.nodes;
+        bool finished = search_root(thread, depth);
+
+        // Even an unfinished iteration is trusted if it got through the last iterations best move
+        if(thread.root[0].score != UNSEARCHED) {
+            thread.best_move = thread.root[0].move;
+            thread.best_score = thread.root[0].score;
+            publish(thread.best_move);
+        }
+        if(!finished) {
+            last_timed_out = true;
+            break;
+        }
+        thread.completed_depth = depth;
+
+        last_branching_factor = std::pow((double) (thread.nodes - started_nodes), 1.0 / depth);
+
+        previous_iteration_ms = last_iteration_ms;
+        last_iteration_ms = timer->elapsedMilliseconds() - started_ms;
+
+        // Each iteration takes about the effective branching factor times longer than the last,
+        // don't start one that is not expected to finish
+        double branching = previous_iteration_ms > 0.01 ? last_iteration_ms / previous_iteration_ms : MIN_BRANCHING;
+        branching = std::min(std::max(branching, MIN_BRANCHING), MAX_BRANCHING);
+        if(last_iteration_ms * branching > timer->remainingMilliseconds()) { break; }
+    }
+}
+
+inline void Alpha_Beta_AI::search_helper(Search_Thread& thread) {
+    // Odd helpers run a ply ahead of the even ones, so the threads spread over two depths at once
+    for(int depth = 1 + thread.id % 2; depth <= max_depth; ++depth) {
+        bool finished = search_root(thread, depth);
+        if(!finished) { return; }
+        thread.completed_depth = depth;
+        thread.best_move = thread.root[0].move;
+        thread.best_score = thread.root[0].score;
+    }
+}
+
+inline bool Alpha_Beta_AI::search_root(Search_Thread& thread, int depth) {
+    int alpha = std::numeric_limits<int>::min();
+    int beta = std::numeric_limits<int>::max();
+    bool finished = true;
+    Position* position = &thread.position;
+    Root_Move* root = thread.root;
+    thread.iteration_depth = depth;
+
+    for(int i = 0; i < thread.root_count; ++i) {
+        Position::Undo undo = make_move(thread, root[i].move);
+        int score = minimax_alpha_beta(thread, depth - 1, alpha, beta);
+        unmake_move(thread, undo);
+
+        // The move that was being searched when time ran out has a made up score
+        if(stopped(thread)) {
+            for(int j = i; j < thread.root_count; ++j) { root[j].score = UNSEARCHED; }
+            finished = false;
+            break;
+        }
+        root[i].score = score;
+        alpha = std::max(alpha, score);
+    }
+
+    // Best first, so the principal variation is searched first next time. Moves that failed low keep
+    // their upper bound, which still ranks them well enough.
+    std::stable_sort(root, root + thread.root_count, [](const Root_Move& a, const Root_Move& b) { return a.score > b.score; });
+
+    // The root window is always fully open, so a finished root search is exact
+    if(finished) {
+        table.store(position->hash() ^ key_salt, root[0].score, depth, Transposition_Table::EXACT, root[0].move);
+    }
+    return finished;
+}
+
+inline int Alpha_Beta_AI::minimax_alpha_beta(Search_Thread& thread, int depth, int alpha, int beta) {
+    Position* position = &thread.position;
+    thread.nodes++;
+    if (depth == 0 || position->is_game_over()) {
+        thread.leaf_evaluations++;
+        return leaf_score(position, thread.id);
+    }
+
+    // Reuse an earlier result for this position if it was searched at least this deep
+    uint64_t key = position->hash() ^ key_salt;
+    Transposition_Table::Entry entry;
+    Move hash_move;
+    if(table.probe(key, entry)) {
+        hash_move = entry.move;
+        if(entry.depth >= depth) {
+            if(entry.bound == Transposition_Table::EXACT) { return entry.score; }
+            if(entry.bound == Transposition_Table::LOWER && entry.score >= beta) { return entry.score; }
+            if(entry.bound == Transposition_Table::UPPER && entry.score <= alpha) { return entry.score; }
+        }
+    }
+
+    int eval;
+    int ply = thread.iteration_depth - depth;
+    MoveList moves;
+    int scores[MoveList::CAPACITY];
+    position->compute_moves(moves);
+    score_moves(thread, moves, scores, hash_move, ply);
+
+    int original_alpha = alpha;
+    int original_beta = beta;
+    Move best_move;
+
+    // If its my turn (Maximize)
+    if (position->next_mover() == me) {
+        int max_eval = std::numeric_limits<int>::min();
+        // For each move, best ordered first
+        for(int i = 0; i < moves.size(); ++i) {
+            Move move = pick_move(moves, scores, i);
+            Position::Undo undo = make_move(thread, move);
+            // Evaluate the move
+            eval = minimax_alpha_beta(thread, depth - 1, alpha, beta);
+            unmake_move(thread, undo);
+
+            // If the move was better than our max, it becomes are max evaluation-
+            // and out lower bound or 'alpha'
+            if(eval > max_eval) {
+                max_eval = eval;
+                best_move = move;
+            }
+            alpha = std::max(alpha, max_eval);
+
+            // A search cut short by the timer is not worth remembering
+            if(stopped(thread)) { return max_eval; }
+
+            // If the move was worse than our lower bound/best move, cut the branch
+            if (beta <= max_eval) {
+                record_cutoff(thread, move, depth, ply, i);
+                break;  // Beta cutoff
+            }
+        }
+        table.store(key, max_eval, depth, max_eval >= original_beta ? Transposition_Table::LOWER :
+                    (max_eval <= original_alpha ? Transposition_Table::UPPER : Transposition_Table::EXACT), best_move);
+        return max_eval;
+    } else {
+        int min_eval = std::numeric_limits<int>::max();
+
+        for(int i = 0; i < moves.size(); ++i) {
+            Move move = pick_move(moves, scores, i);
+            Position::Undo undo = make_move(thread, move);
+
+            eval = minimax_alpha_beta(thread, depth - 1, alpha, beta);
+            unmake_move(thread, undo);
+
+            if(eval < min_eval) {
+                min_eval = eval;
+                best_move = move;
+            }
+            beta = std::min(beta, min_eval);
+
+            if(stopped(thread)) { return min_eval; }
+
+            if (min_eval <= alpha) {
+                record_cutoff(thread, move, depth, ply, i);
+                break;  // Alpha cutoff
+            }
+        }
+        table.store(key, min_eval, depth, min_eval <= original_alpha ? Transposition_Table::UPPER :
+                    (min_eval >= original_beta ? Transposition_Table::LOWER : Transposition_Table::EXACT), best_move);
+        return min_eval;
+    }
+}
+
+inline long long Alpha_Beta_AI::nodes_searched() const {
+    long long nodes = 0;
+    for(const Search_Thread& thread : threads) { nodes += thread.nodes; }
+    return nodes;
+}
+
+inline bool Alpha_Beta_AI::search_stats(Search_Stats& stats) const {
+    stats = Search_Stats();
+    for(const Search_Thread& thread : threads) {
+        stats.nodes += thread.nodes;
+        stats.leaf_evaluations += thread.leaf_evaluations;
+        stats.beta_cutoffs += thread.cutoffs;
+        stats.first_move_cutoffs += thread.first_move_cutoffs;
+    }
+    stats.depth = last_completed_depth;
+    stats.branching_factor = last_branching_factor;
+    stats.timed_out = last_timed_out;
+    stats.book_move = last_book_move;
+    stats.has_score = last_completed_depth > 0;
+    stats.score = last_best_score;
+    return true;
+}
+
+inline double Alpha_Beta_AI::first_move_cutoff_rate() const {
+    long long cutoffs = 0;
+    long long first_move_cutoffs = 0;
+    for(const Search_Thread& thread : threads) {
+        cutoffs += thread.cutoffs;
+        first_move_cutoffs += thread.first_move_cutoffs;
+    }
+    return cutoffs == 0 ? 0 : (double) first_move_cutoffs / cutoffs;
+}
+
+inline void Alpha_Beta_AI::score_moves(const Search_Thread& thread, const MoveList& moves, int scores[], Move hash_move, int ply) const {
+    const Position& position = thread.position;
+    const int* side_history = thread.history[position.next_mover() == Boop::P1 ? 0 : 1];
+    for(int i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        int gain;
+        if(move == hash_move) {
+            scores[i] = HASH_MOVE_SCORE;
+        } else if((gain = position.tactical_gain(move)) > 0) {
+            scores[i] = TACTICAL_SCORE + gain;
+        } else if(move == thread.killers[ply][0]) {
+            scores[i] = KILLER_SCORE + 1;
+        } else if(move == thread.killers[ply][1]) {
+            scores[i] = KILLER_SCORE;
+        } else {
+            scores[i] = side_history[move.index()];
+        }
+    }
+}
+
+inline Move Alpha_Beta_AI::pick_move(MoveList& moves, int scores[], int i) {
+    // Most nodes cut off after a move or two, so a full sort would mostly be wasted
+    int best = i;
+    for(int j = i + 1; j < moves.size(); ++j) {
+        if(scores[j] > scores[best]) { best = j; }
+    }
+    std::swap(moves[i], moves[best]);
+    std::swap(scores[i], scores[best]);
+    return moves[i];
+}
+
+inline void Alpha_Beta_AI::record_cutoff(Search_Thread& thread, Move move, int depth, int ply, int move_number) {
+    thread.cutoffs++;
+    if(move_number == 0) { thread.first_move_cutoffs++; }
+    if(thread.position.tactical_gain(move) > 0) { return; } // Already ordered early
+
+    if(move != thread.killers[ply][0]) {
+        thread.killers[ply][1] = thread.killers[ply][0];
+        thread.killers[ply][0] = move;
+    }
+
+    int* side_history = thread.history[thread.position.next_mover() == Boop::P1 ? 0 : 1];
+    side_history[move.index()] += depth * depth;
+    if(side_history[move.index()] > HISTORY_LIMIT) { // Keep history below the killer scores
+        for(int i = 0; i < Move::INDEX_COUNT; ++i) { side_history[i] /= 2; }
+    }
+}
+
+#endif
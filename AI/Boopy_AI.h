@@ -11,41 +11,40 @@
 class Boopy_AI : public AI {
     public:
         Boopy_AI() { }
-        std::string think(std::queue<std::string> moves, Timer& timer) override;
+        Move think(const MoveList& moves, Timer& timer) override;
     private:
         Boop::PieceType board[Boop::SIZE][Boop::SIZE];
         // Count the number of different squares from the current board state
-        int board_difference(Boop* future);
+        int board_difference(const Position* future);
 };
 
-std::string Boopy_AI::think(std::queue<std::string> moves, Timer& timer) {
-    std::string best_move;
+Move Boopy_AI::think(const MoveList& moves, Timer& timer) {
+    Move best_move;
     // Check timer.times_up() between loops as to not go over the time limit
     int boops;
     int most_boops = -1;
-    Boop* future;
+    // Try each move on a single copy of the game state, making and unmaking moves on it
+    Position future = game->position();
 
     game->clone_board(board);
 
-    while(!moves.empty()) {
-        future = game->clone();
-        future -> make_move(moves.front( ));
-        boops = board_difference(future);
-        delete future;
+    for(Move move : moves) {
+        Position::Undo undo = future.make_move(move);
+        boops = board_difference(&future);
+        future.unmake_move(undo);
 
         if(boops > most_boops) {
             most_boops = boops;
-            best_move = moves.front();
+            best_move = move;
         }
 
-        moves.pop( );
-        if(timer.times_up()) { return best_move; }
+        if(timer.times_up()) { break; }
     }
 
     return best_move;
 }
 
-int Boopy_AI::board_difference(Boop* future) {
+int Boopy_AI::board_difference(const Position* future) {
     int c = 0;
     Boop::PieceType future_board[6][6];
     future->clone_board(future_board);
@@ -8,7 +8,7 @@
  *      Lets humans fight against the AI by passing this AI to the game
 */
 
-class Human_AI : public AI {
+class Human_AI : public String_AI {
     public:
         Human_AI() { }
         std::string think(std::queue<std::string> moves, Timer& timer) override;
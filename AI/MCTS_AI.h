@@ -0,0 +1,299 @@
+#ifndef MCTS_AI_H
+#define MCTS_AI_H
+
+#include "../AI.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Goal of the AI:
+ *      Monte Carlo Tree Search, no evaluation function at all. Walks down the tree picking moves by UCT,
+ *      grows the tree by one node's children per playout, plays the rest of the game out with lightly
+ *      guided random moves, and counts who won. Plays the move that was visited the most.
+ *      Uses the whole think time, and more threads play more playouts in the same time.
+ *      Tree nodes come from an arena that is reset every think, so searching never calls new.
+ *      Threads descending the same tree count a visit before the result is in (virtual loss),
+ *      which steers them into different branches.
+*/
+
+class MCTS_AI : public AI {
+    public:
+        /**
+         * @param node_capacity How many tree nodes the arena holds, the tree stops growing when it is full
+        */
+        explicit MCTS_AI(size_t node_capacity = 1 << 20) : arena(new Node[node_capacity]), capacity(node_capacity) { }
+        Move think(const MoveList& moves, Timer& timer) override;
+
+        /**
+         * @brief Sets how many threads play out games each move, the calling thread counts as one
+         * @param count The number of threads, at least 1
+        */
+        void set_threads(int count) { thread_count = std::max(count, 1); }
+
+        /**
+         * @brief The number of playouts per second during the last think
+        */
+        double playouts_per_second() const { return last_playouts_per_second; }
+
+        /**
+         * @brief The number of playouts during the last think, over all threads
+        */
+        long long playouts() const { return last_playouts; }
+
+        bool search_stats(Search_Stats& stats) const override;
+
+    private:
+        static constexpr double EXPLORATION = 1.4;
+        static const int MAX_TREE_DEPTH = 2 * Boop::turn_limit;  // No game Boop::play allows runs longer
+        static const int PLAYOUT_SAMPLES = 4;       // Random moves looked at for each playout move
+        static const int PUBLISH_INTERVAL = 256;    // Playouts between publishing the best move so far
+        enum Expansion : uint8_t { LEAF, EXPANDING, EXPANDED };
+
+        struct Node {
+            Move move;                                  // The move that led here
+            Boop::who mover;                            // The player who made it
+            std::atomic<uint8_t> expansion{LEAF};
+            int first_child = 0;
+            int child_count = 0;
+            std::atomic<int> visits{0};
+            std::atomic<int> half_points{0};            // 2 per win and 1 per tie for the mover
+        };
+
+        std::unique_ptr<Node[]> arena;
+        size_t capacity;
+        std::atomic<size_t> nodes_used{0};
+        int thread_count = 1;
+        double last_playouts_per_second = 0;
+        long long last_playouts = 0;
+        int last_depth = 0;
+        Timer* timer;
+
+        // Plays out games from the root until the timer runs out, returning how many were played
+        // and how deep into the tree the deepest one started. The main thread also publishes the best move.
+        long long search(uint64_t seed, bool main, int& depth);
+
+        // The root move visited the most, the one the search trusts the most
+        Move most_visited() const;
+
+        /**
+         * @brief Claims a block of nodes from the arena
+         * @return The index of the first node, or -1 if the arena is full
+        */
+        int allocate(int count);
+
+        // Gives a leaf node its children, unless another thread is already doing it or the arena is full.
+        // The root skips moves that are mirror images of one another on a symmetric board.
+        void expand(Node& node, const Position& position, bool root = false);
+
+        // Picks the child with the best upper confidence bound
+        Node& select_child(const Node& node) const;
+
+        /**
+         * @brief Plays random moves until the game ends or runs too long
+         * @param plies The moves made in the game so far, counted like Boop::moves_played
+         * @return The winner, or NEUTRAL for a game that hit the turn limit
+        */
+        static Boop::who playout(Position& position, int plies, uint64_t& rng);
+
+        static uint64_t next_random(uint64_t& rng) {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            return rng;
+        }
+};
+
+inline Move MCTS_AI::think(const MoveList& moves, Timer& timer) {
+    this->timer = &timer;
+    last_playouts = 0;
+    last_depth = 0;
+    nodes_used = 0; // Reset the arena
+    if(moves.size() == 1) { return moves[0]; }
+
+    // The root is node 0
+    Node& root = arena[allocate(1)];
+    root.move = Move();
+    root.mover = game->position().last_mover();
+    root.expansion = LEAF;
+    root.visits = 0;
+    root.half_points = 0;
+    expand(root, game->position(), true);
+
+    std::vector<std::thread> helpers;
+    std::vector<long long> playouts(thread_count, 0);
+    std::vector<int> depths(thread_count, 0);
+    for(int i = 1; i < thread_count; ++i) {
+        helpers.emplace_back([this, &playouts, &depths, i] { playouts[i] = search(0x9E3779B97F4A7C15ULL * (i + 1), false, depths[i]); });
+    }
+    playouts[0] = search(0x9E3779B97F4A7C15ULL ^ (uint64_t) game->moves_completed(), true, depths[0]);
+    for(std::thread& helper : helpers) { helper.join(); }
+
+    long long total = 0;
+    for(long long count : playouts) { total += count; }
+    last_playouts = total;
+    last_depth = *std::max_element(depths.begin(), depths.end());
+    double seconds = timer.elapsedMilliseconds() / 1000;
+    last_playouts_per_second = seconds > 0 ? total / seconds : 0;
+
+    // Only a tiny arena leaves the root without children
+    return root.child_count > 0 ? most_visited() : moves[0];
+}
+
+inline Move MCTS_AI::most_visited() const {
+    const Node& root = arena[0];
+    Move best_move;
+    int most_visits = -1;
+    for(int i = 0; i < root.child_count; ++i) {
+        const Node& child = arena[root.first_child + i];
+        int visits = child.visits.load(std::memory_order_relaxed);
+        if(visits > most_visits) {
+            most_visits = visits;
+            best_move = child.move;
+        }
+    }
+    return best_move;
+}
+
+inline long long MCTS_AI::search(uint64_t seed, bool main, int& depth) {
+    uint64_t rng = seed | 1;
+    long long count = 0;
+    depth = 0;
+    Node* path[MAX_TREE_DEPTH + 1];
+
+    while(!timer->times_up()) {
+        Position position = game->position();
+        int plies = game->moves_played();
+        int length = 0;
+        Node* node = &arena[0];
+        path[length++] = node;
+        node->visits++;
+
+        // Selection, counting each visit on the way down so other threads see the branch as taken (virtual loss)
+        while(node->expansion.load(std::memory_order_acquire) == EXPANDED && node->child_count > 0) {
+            node = &select_child(*node);
+            position.make_move(node->move);
+            plies++;
+            path[length++] = node;
+            node->visits++;
+        }
+
+        // Expansion, a leaf gets its children the second time it is reached
+        if(node->visits > 1 && !position.is_game_over() && plies < 2 * Boop::turn_limit && length < MAX_TREE_DEPTH) {
+            expand(*node, position);
+            if(node->expansion.load(std::memory_order_acquire) == EXPANDED && node->child_count > 0) {
+                node = &arena[node->first_child + next_random(rng) % node->child_count];
+                position.make_move(node->move);
+                plies++;
+                path[length++] = node;
+                node->visits++;
+            }
+        }
+
+        depth = std::max(depth, length - 1);
+
+        // Simulation and backpropagation
+        Boop::who winner = playout(position, plies, rng);
+        for(int i = 0; i < length; ++i) {
+            path[i]->half_points += (winner == Boop::NEUTRAL ? 1 : (winner == path[i]->mover ? 2 : 0));
+        }
+        count++;
+
+        // The main thread keeps the most visited move published, in case think is abandoned
+        if(main && count % PUBLISH_INTERVAL == 1 && arena[0].child_count > 0) { publish(most_visited()); }
+    }
+    return count;
+}
+
+inline bool MCTS_AI::search_stats(Search_Stats& stats) const {
+    stats = Search_Stats();
+    stats.nodes = std::min(nodes_used.load(), capacity);
+    stats.leaf_evaluations = last_playouts;
+    stats.depth = last_depth;
+    return true;
+}
+
+inline int MCTS_AI::allocate(int count) {
+    size_t first = nodes_used.fetch_add(count);
+    if(first + count > capacity) { return -1; }
+    return (int) first;
+}
+
+inline void MCTS_AI::expand(Node& node, const Position& position, bool root) {
+    uint8_t expected = LEAF;
+    if(!node.expansion.compare_exchange_strong(expected, EXPANDING)) { return; }
+
+    MoveList moves;
+    position.compute_moves(moves);
+    if(root) { position.drop_symmetric_moves(moves); }
+    int first = allocate(moves.size());
+    if(first < 0) { // The arena is full, leave it a leaf for good
+        node.expansion.store(EXPANDING, std::memory_order_release);
+        return;
+    }
+
+    for(int i = 0; i < moves.size(); ++i) {
+        Node& child = arena[first + i];
+        child.move = moves[i];
+        child.mover = position.next_mover();
+        child.expansion.store(LEAF, std::memory_order_relaxed);
+        child.first_child = 0;
+        child.child_count = 0;
+        child.visits.store(0, std::memory_order_relaxed);
+        child.half_points.store(0, std::memory_order_relaxed);
+    }
+    node.first_child = first;
+    node.child_count = moves.size();
+    node.expansion.store(EXPANDED, std::memory_order_release);
+}
+
+inline MCTS_AI::Node& MCTS_AI::select_child(const Node& node) const {
+    double log_visits = std::log((double) std::max(node.visits.load(std::memory_order_relaxed), 1));
+    Node* best = &arena[node.first_child];
+    double best_bound = -1;
+
+    for(int i = 0; i < node.child_count; ++i) {
+        Node& child = arena[node.first_child + i];
+        int visits = child.visits.load(std::memory_order_relaxed);
+        if(visits == 0) { return child; } // Try every move once before trusting any of them
+
+        // Visits in flight have not added their points yet, so they count as losses until they do
+        double mean = child.half_points.load(std::memory_order_relaxed) / (2.0 * visits);
+        double bound = mean + EXPLORATION * std::sqrt(log_visits / visits);
+        if(bound > best_bound) {
+            best_bound = bound;
+            best = &child;
+        }
+    }
+    return *best;
+}
+
+inline Boop::who MCTS_AI::playout(Position& position, int plies, uint64_t& rng) {
+    // Boop::play calls a game a tie once it has made 2 * turn_limit moves, removals included
+    for(; plies < 2 * Boop::turn_limit; ++plies) {
+        if(position.is_game_over()) { return position.winning(); }
+
+        MoveList moves;
+        position.compute_moves(moves);
+
+        // Lightly guided, the most forcing of a few random moves
+        Move move = moves[next_random(rng) % moves.size()];
+        int gain = position.tactical_gain(move);
+        for(int i = 1; i < PLAYOUT_SAMPLES; ++i) {
+            Move sample = moves[next_random(rng) % moves.size()];
+            int sample_gain = position.tactical_gain(sample);
+            if(sample_gain > gain) {
+                move = sample;
+                gain = sample_gain;
+            }
+        }
+        position.make_move(move);
+    }
+    return Boop::NEUTRAL;
+}
+
+#endif
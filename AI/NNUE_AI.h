@@ -0,0 +1,68 @@
+#ifndef NNUE_AI_H
+#define NNUE_AI_H
+
+#include "Alpha_Beta_AI.h"
+#include "../nnue.h"
+
+#include <vector>
+
+/**
+ * Goal of the AI:
+ *      The alpha beta search with the network evaluation from nnue.h. Each search thread keeps a stack of
+ *      accumulators, one per ply, and every move the search makes works out the next one from the last,
+ *      so a leaf only runs the small layers after the accumulator.
+*/
+
+class NNUE_AI : public Alpha_Beta_AI {
+    public:
+        /**
+         * @param network A loaded network, which may be shared by many AIs and threads
+        */
+        explicit NNUE_AI(const NNUE_Network* network, size_t table_megabytes = 16)
+            : Alpha_Beta_AI(table_megabytes), network(network) { track_moves = true; }
+    private:
+        static const int WIN_SCORE = 9999;
+
+        // One accumulator per ply of the search path, stack[ply] is the current position's
+        struct Accumulator_Stack {
+            std::vector<NNUE_Accumulator> stack = std::vector<NNUE_Accumulator>(MAX_DEPTH + 2);
+            int ply = 0;
+        };
+
+        const NNUE_Network* network;
+        std::vector<Accumulator_Stack> stacks;
+
+        int leaf_score(const Position* position, int thread) const override;
+        void new_search(const Position& root) override;
+        void made_move(int thread, const Position& position, const Position::Undo& undo) override;
+        void unmade_move(int thread) override;
+};
+
+void NNUE_AI::new_search(const Position& root) {
+    // Every thread starts from the root
+    stacks.resize(thread_count());
+    for(Accumulator_Stack& thread : stacks) {
+        thread.ply = 0;
+        network->refresh(root, thread.stack[0]);
+    }
+}
+
+void NNUE_AI::made_move(int thread, const Position& position, const Position::Undo& undo) {
+    Accumulator_Stack& path = stacks[thread];
+    network->update(path.stack[path.ply], path.stack[path.ply + 1], position, undo);
+    path.ply++;
+}
+
+void NNUE_AI::unmade_move(int thread) { stacks[thread].ply--; }
+
+int NNUE_AI::leaf_score(const Position* position, int thread) const {
+    // The network only scores games in progress, a finished game is won outright
+    if(position->is_game_over()) {
+        return position->winning() == me ? WIN_SCORE : -WIN_SCORE;
+    }
+    const Accumulator_Stack& path = stacks[thread];
+    int score = network->evaluate(path.stack[path.ply], position->next_mover());
+    return position->next_mover() == me ? score : -score;
+}
+
+#endif
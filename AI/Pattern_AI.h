@@ -0,0 +1,67 @@
+#ifndef PATTERN_AI_H
+#define PATTERN_AI_H
+
+#include "Alpha_Beta_AI.h"
+#include "../pattern_evaluator.h"
+
+#include <vector>
+
+/**
+ * Goal of the AI:
+ *      Scores exactly like Minimax_Alpha_Beta_AI, but with the table lookups of pattern_evaluator.h in
+ *      place of the board scans. Each search thread keeps the window indexes of every ply of its path,
+ *      updated from the last ply's on each move, so a leaf only sums the tables.
+*/
+
+class Pattern_AI : public Alpha_Beta_AI {
+    public:
+        Pattern_AI(size_t table_megabytes = 16) : Alpha_Beta_AI(table_megabytes) { track_moves = true; }
+
+        /**
+         * @brief Replaces the evaluation weights, such as ones tuned by tools/tune.cc and read with Eval_Weights::load
+        */
+        void set_weights(const Eval_Weights& weights) {
+            evaluator = Pattern_Evaluator(weights);
+            table.clear(); // Scores from the old weights would mix with the new ones
+        }
+    private:
+        // The windows of each ply of the search path, stack[ply] is the current position's
+        struct Windows_Stack {
+            std::vector<Pattern_Windows> stack = std::vector<Pattern_Windows>(MAX_DEPTH + 2);
+            int ply = 0;
+        };
+
+        Pattern_Evaluator evaluator{Eval_Weights::alpha_beta()};
+        std::vector<Windows_Stack> stacks;
+
+        int leaf_score(const Position* position, int thread) const override;
+        void new_search(const Position& root) override;
+        void made_move(int thread, const Position& position, const Position::Undo& undo) override;
+        void unmade_move(int thread) override;
+};
+
+void Pattern_AI::new_search(const Position& root) {
+    // Every thread starts from the root
+    stacks.resize(thread_count());
+    for(Windows_Stack& thread : stacks) {
+        thread.ply = 0;
+        Pattern_Evaluator::refresh(root, thread.stack[0]);
+    }
+}
+
+void Pattern_AI::made_move(int thread, const Position& position, const Position::Undo& undo) {
+    Windows_Stack& path = stacks[thread];
+    Pattern_Evaluator::update(path.stack[path.ply], path.stack[path.ply + 1], position, undo);
+    path.ply++;
+}
+
+void Pattern_AI::unmade_move(int thread) { stacks[thread].ply--; }
+
+int Pattern_AI::leaf_score(const Position* position, int thread) const {
+    // The evaluation is positive when P2 is winning
+    const Windows_Stack& path = stacks[thread];
+    int eval = evaluator.evaluate(*position, path.stack[path.ply]);
+    return me == Boop::P2 ? eval : -eval;
+}
+
+#endif
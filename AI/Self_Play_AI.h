@@ -0,0 +1,49 @@
+#ifndef SELF_PLAY_AI_H
+#define SELF_PLAY_AI_H
+
+#include "Minimax_Alpha_Beta_AI.h"
+
+/**
+ * Goal of the AI:
+ *      Play games for the tuning tools. Opens each game with a few random moves, from its own seeded
+ *      generator so a game can be played again, then searches every move to a fixed depth.
+ *      Random moves report no search statistics, so they never end up as tuning samples.
+*/
+
+class Self_Play_AI : public Minimax_Alpha_Beta_AI {
+    public:
+        /**
+         * @param depth How deep every searched move goes
+         * @param random_plies How many plies of the game are played at random, counting both players
+        */
+        Self_Play_AI(int depth, int random_plies) : Minimax_Alpha_Beta_AI(4), random_plies(random_plies) { set_max_depth(depth); }
+
+        /**
+         * @brief Seeds the random opening moves, set it before each game
+        */
+        void set_seed(uint64_t seed) { random = seed * 0x9E3779B97F4A7C15ULL + 1; }
+
+        Move think(const MoveList& moves, Timer& timer) override;
+        bool search_stats(Search_Stats& stats) const override;
+
+    private:
+        int random_plies;
+        uint64_t random = 1;
+        bool played_random = false;
+};
+
+inline Move Self_Play_AI::think(const MoveList& moves, Timer& timer) {
+    played_random = game->moves_completed() < random_plies;
+    if(!played_random) { return Minimax_Alpha_Beta_AI::think(moves, timer); }
+
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    return moves[random % moves.size()];
+}
+
+inline bool Self_Play_AI::search_stats(Search_Stats& stats) const {
+    return !played_random && Minimax_Alpha_Beta_AI::search_stats(stats);
+}
+
+#endif
@@ -11,11 +11,11 @@
 class Template_AI : public AI {
     public:
         Template_AI() { }
-        std::string think(std::queue<std::string> moves, Timer& timer) override;
+        Move think(const MoveList& moves, Timer& timer) override;
 };
 
-std::string Template_AI::think(std::queue<std::string> moves, Timer& timer) {
-    std::string best_move;
+Move Template_AI::think(const MoveList& moves, Timer& timer) {
+    Move best_move;
     // Check timer.times_up() between loops as to not go over the time limit
     
     
@@ -2,28 +2,76 @@
 #define TIMER_H
 
 #include <iostream>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 using namespace std::chrono;
 
+/**
+ * Times one think. While it is running, a watchdog thread raises a flag at the deadline, so times_up()
+ * is a single atomic load that searches can call in every node. The clock is still read every
+ * CLOCK_CHECK_INTERVAL calls, in case the watchdog is slow to be scheduled on a busy machine.
+*/
 class Timer {
     public:
         Timer(double duration) {
             duration_ms = duration;
         }
 
+        ~Timer() {
+            if(watchdog.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(watchdog_lock);
+                    quit = true;
+                }
+                watchdog_wake.notify_one();
+                watchdog.join();
+            }
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator = (const Timer&) = delete;
+
         void start() {
             start_time_point = high_resolution_clock::now();
+            expired.store(false, std::memory_order_relaxed);
             running = true;
+            {
+                std::lock_guard<std::mutex> lock(watchdog_lock);
+                deadline = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double, std::milli>(duration_ms));
+                armed = true;
+            }
+            if(!watchdog.joinable()) { watchdog = std::thread(&Timer::watch, this); }
+            watchdog_wake.notify_one();
         }
 
         void stop() {
             end_time_point = high_resolution_clock::now();
             running = false;
+            {
+                std::lock_guard<std::mutex> lock(watchdog_lock);
+                armed = false;
+            }
+            watchdog_wake.notify_one();
+        }
+
+        // Ends the think early, times_up() stays true until the next start()
+        void cancel() {
+            expired.store(true, std::memory_order_relaxed);
         }
 
         bool times_up() const {
-            auto elapsed_ms = elapsedMilliseconds();
-            return elapsed_ms >= duration_ms;
+            if(!running) { return elapsedMilliseconds() >= duration_ms; }
+            if(expired.load(std::memory_order_relaxed)) { return true; }
+            // A plain load and store rather than an atomic add, threads polling together may lose a count
+            unsigned count = polls.load(std::memory_order_relaxed) + 1;
+            polls.store(count, std::memory_order_relaxed);
+            if(count % CLOCK_CHECK_INTERVAL != 0) { return false; }
+            if(elapsedMilliseconds() < duration_ms) { return false; }
+            expired.store(true, std::memory_order_relaxed);
+            return true;
         }
 
         double elapsedMilliseconds() const {
@@ -35,11 +83,43 @@ class Timer {
             }
         }
 
+        double remainingMilliseconds() const {
+            return duration_ms - elapsedMilliseconds();
+        }
+
     private:
+        static const unsigned CLOCK_CHECK_INTERVAL = 1024;
+
         double duration_ms;
         time_point<high_resolution_clock> start_time_point;
         time_point<high_resolution_clock> end_time_point;
         bool running = false;
+
+        // Raised at the deadline by the watchdog, by cancel(), or by times_up() when it reads the clock itself
+        mutable std::atomic<bool> expired{false};
+        mutable std::atomic<unsigned> polls{0};
+
+        std::thread watchdog;
+        std::mutex watchdog_lock;
+        std::condition_variable watchdog_wake;
+        time_point<steady_clock> deadline;
+        bool armed = false;
+        bool quit = false;
+
+        // Sleeps until the deadline of the running think, then raises the flag
+        void watch() {
+            std::unique_lock<std::mutex> lock(watchdog_lock);
+            while(!quit) {
+                if(!armed) {
+                    watchdog_wake.wait(lock);
+                } else if(steady_clock::now() >= deadline) {
+                    expired.store(true, std::memory_order_relaxed);
+                    armed = false;
+                } else {
+                    watchdog_wake.wait_until(lock, deadline);
+                }
+            }
+        }
 };
 
-#endif
\ No newline at end of file
+#endif
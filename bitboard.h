@@ -0,0 +1,90 @@
+/**
+*    @file: bitboard.h
+*   @brief: Helpers for the 6x6 board stored as the low 36 bits of a uint64_t, square (x, y) is bit (y * SIZE + x).
+*           Shared by the rules in position.cc and the evaluator.
+*
+*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+namespace bitboard {
+    const int SIZE = 6;
+
+    inline int popcount(uint64_t bits) { return __builtin_popcountll(bits); }
+
+    // Returns the mask of every square (x, y) for which (x + dx, y + dy) is still on the board
+    constexpr uint64_t on_board_after(int dx, int dy) {
+        uint64_t mask = 0;
+        for(int y = 0; y < SIZE; ++y) {
+            for(int x = 0; x < SIZE; ++x) {
+                if(x + dx >= 0 && x + dx < SIZE && y + dy >= 0 && y + dy < SIZE) {
+                    mask |= 1ULL << (y * SIZE + x);
+                }
+            }
+        }
+        return mask;
+    }
+
+    constexpr uint64_t ALL_SQUARES = on_board_after(0, 0);
+    constexpr uint64_t COLUMN_X0 = ~on_board_after(-1, 0) & ALL_SQUARES;
+    constexpr uint64_t COLUMN_X5 = ~on_board_after( 1, 0) & ALL_SQUARES;
+    constexpr uint64_t ROW_Y0    = ~on_board_after(0, -1) & ALL_SQUARES;
+    constexpr uint64_t ROW_Y5    = ~on_board_after(0,  1) & ALL_SQUARES;
+    constexpr uint64_t ROWS_Y0_Y1 = ROW_Y0 | (ROW_Y0 << SIZE);
+    constexpr uint64_t TRI_ANCHORS = on_board_after(2, 2); // Top left corners of the 3x3 sub grids
+
+    // Moves every bit in the board by (DX, DY), dropping the bits that would leave the board
+    template<int DX, int DY>
+    inline uint64_t shift(uint64_t bits) {
+        constexpr uint64_t valid = on_board_after(DX, DY);
+        constexpr int delta = DY * SIZE + DX;
+        bits &= valid;
+        if constexpr (delta >= 0) { return bits << delta; }
+        else { return bits >> -delta; }
+    }
+
+    // Sets the bit of every square (x, y) whose neighbour at (x + DX, y + DY) is set
+    template<int DX, int DY>
+    inline uint64_t look(uint64_t bits) { return shift<-DX, -DY>(bits); }
+
+    // True for squares where at least three of the four inputs are set
+    inline uint64_t three_of_four(uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
+        return (a & b & (c | d)) | (c & d & (a | b));
+    }
+
+    // Returns true if any three of the given pieces are in a row
+    inline bool has_three_in_row(uint64_t mine) {
+        return (mine & look<1, 0>(mine) & look<2, 0>(mine)) ||    // E
+               (mine & look<1, -1>(mine) & look<2, -2>(mine)) ||  // SE
+               (mine & look<0, -1>(mine) & look<0, -2>(mine)) ||  // S
+               (mine & look<-1, -1>(mine) & look<-2, -2>(mine));  // SW
+    }
+
+    // Counts the 3x3 sub grids with at least three corners set, for a single piece type. The array version of
+    // this check read board[x][y-2], which wrapped into the end of the previous column (x-1, y+4) for the
+    // bottom two rows. Those squares are matched here too so evaluations stay identical.
+    inline int count_tri_pattern(uint64_t mine) {
+        uint64_t corner[4];
+        corner[0] = mine;
+        corner[1] = look<2, 0>(mine);
+        corner[2] = (look<0, -2>(mine) & ~ROWS_Y0_Y1) | (look<-1, 4>(mine) & ROWS_Y0_Y1);
+        corner[3] = (look<2, -2>(mine) & ~ROWS_Y0_Y1) | (look<1, 4>(mine) & ROWS_Y0_Y1);
+        return popcount(three_of_four(corner[0], corner[1], corner[2], corner[3]) & TRI_ANCHORS);
+    }
+
+    // Counts the 3x3 sub grids with at least three corners set, for all of a players pieces.
+    // Corners on the outer edge of the board do not count.
+    inline int count_friendly_tri_pattern(uint64_t mine) {
+        uint64_t corner[4];
+        corner[0] = mine & ~COLUMN_X0 & ~ROW_Y0;
+        corner[1] = look<2, 0>(mine & ~COLUMN_X5 & ~ROW_Y0);
+        corner[2] = look<0, 2>(mine & ~COLUMN_X0 & ~ROW_Y5);
+        corner[3] = look<2, 2>(mine & ~COLUMN_X5 & ~ROW_Y5);
+        return popcount(three_of_four(corner[0], corner[1], corner[2], corner[3]) & TRI_ANCHORS);
+    }
+}
+
+#endif
@@ -10,7 +10,11 @@
 #define BOOP_H
 
 #include "colors.h"
+#include "game_record.h"
+#include "move.h"
+#include "position.h"
 #include "AI.h"
+#include <algorithm>
 #include <queue>
 #include <string>
 using namespace std;
@@ -26,12 +30,12 @@ const string none[3]  = { "       ", "       ", "       " };
 const string bunny[3]  = { " (\\_/) ", " (•_•) ", " / ><\\ " };
 const string rabbit[3] = { "(\\(\\   ", "(-.-)  ", "_(\")(\")" };
 
-class Boop {
+class Boop : public Boop_Types {
     public:
-        static const int SIZE = 6;
-        enum PieceType { NONE, P1_KIT, P1_CAT, P2_KIT, P2_CAT };
-        enum MoveState { MAKE_MOVE, REMOVE_THREE, REMOVE_ONE };
-        enum who { P1, NEUTRAL, P2 };
+        using Undo = Position::Undo;
+
+        // A game still going after this many turns of both players is a tie
+        static const int turn_limit = 300;
 
         // Constructor(s) & Deconstructor
         Boop();
@@ -40,6 +44,90 @@ class Boop {
         Boop& operator = (const Boop& other);
         
 
+        // The search statistics of one player summed over their thinks
+        struct Search_Totals {
+            int thinks = 0;
+            long long nodes = 0;
+            long long leaf_evaluations = 0;
+            long long beta_cutoffs = 0;
+            long long first_move_cutoffs = 0;
+            long long depth_sum = 0;
+            int max_depth = 0;
+            double branching_sum = 0;
+            int branching_thinks = 0;
+            int time_outs = 0;
+            int book_moves = 0;                 // Moves played from an opening book, not counted as thinks
+
+            void add(const Search_Stats& stats) {
+                if(stats.book_move) {
+                    book_moves++;
+                    return;
+                }
+                thinks++;
+                nodes += stats.nodes;
+                leaf_evaluations += stats.leaf_evaluations;
+                beta_cutoffs += stats.beta_cutoffs;
+                first_move_cutoffs += stats.first_move_cutoffs;
+                depth_sum += stats.depth;
+                max_depth = max(max_depth, stats.depth);
+                if(stats.branching_factor > 0) {
+                    branching_sum += stats.branching_factor;
+                    branching_thinks++;
+                }
+                if(stats.timed_out) { time_outs++; }
+            }
+
+            void add(const Search_Totals& other) {
+                thinks += other.thinks;
+                nodes += other.nodes;
+                leaf_evaluations += other.leaf_evaluations;
+                beta_cutoffs += other.beta_cutoffs;
+                first_move_cutoffs += other.first_move_cutoffs;
+                depth_sum += other.depth_sum;
+                max_depth = max(max_depth, other.max_depth);
+                branching_sum += other.branching_sum;
+                branching_thinks += other.branching_thinks;
+                time_outs += other.time_outs;
+                book_moves += other.book_moves;
+            }
+
+            double average_depth() const { return thinks == 0 ? 0 : (double) depth_sum / thinks; }
+            double average_branching() const { return branching_thinks == 0 ? 0 : branching_sum / branching_thinks; }
+            double first_move_cutoff_rate() const { return beta_cutoffs == 0 ? 0 : (double) first_move_cutoffs / beta_cutoffs; }
+        };
+
+        /**
+         * How play() runs each think. By default think runs on the calling thread and is trusted to
+         * watch its timer. Enforced, it runs on a worker thread and the game moves on at the deadline.
+        */
+        struct Deadline_Policy {
+            bool enforce = false;
+            double grace_ms = 0;                // How long past the deadline a think may still return its own move
+            bool random_default = false;        // Play a random legal move rather than the first when the AI has none to offer
+            int forfeit_after = 0;              // Overruns that lose the game, 0 to never forfeit
+        };
+
+        // How one player kept to their deadlines, only counted when deadlines are enforced
+        struct Overrun_Totals {
+            int late = 0;                       // Thinks that returned after the deadline but within the grace
+            int overruns = 0;                   // Thinks still running when the grace ran out, or not done with the last one
+            int published_moves = 0;            // Overruns that played the move the AI had published
+            int default_moves = 0;              // Overruns and illegal moves that played the default move
+            int illegal_moves = 0;              // Thinks that returned a move that is not legal
+            double worst_ms = 0;                // The furthest past the deadline a move was played
+            bool forfeited = false;
+
+            void add(const Overrun_Totals& other) {
+                late += other.late;
+                overruns += other.overruns;
+                published_moves += other.published_moves;
+                default_moves += other.default_moves;
+                illegal_moves += other.illegal_moves;
+                worst_ms = max(worst_ms, other.worst_ms);
+                forfeited = forfeited || other.forfeited;
+            }
+        };
+
         struct Game_Results {
             // Game results
             Boop::who winner = Boop::NEUTRAL;
@@ -50,55 +138,151 @@ class Boop {
             // AI results
             double P1_avg_think_time = 0;
             double P2_avg_think_time = 0;
+
+            // Search statistics, only for AIs that report them
+            Search_Totals P1_search;
+            Search_Totals P2_search;
+
+            // Missed deadlines, only with an enforced Deadline_Policy
+            Overrun_Totals P1_overruns;
+            Overrun_Totals P2_overruns;
         };
 
+        /**
+         * @brief Sets how play() keeps the AIs to their think time
+         * @param policy The policy for every game from now on
+        */
+        void set_deadline_policy(const Deadline_Policy& policy) { this->policy = policy; }
+
+        /**
+         * @brief Has play() hand every game it finishes to a recorder, such as a Game_Writer
+         * @param recorder The recorder, shared by any number of games, or nullptr to stop recording
+         * @param with_scores Whether to record the search score the AIs report for each move
+        */
+        void set_recorder(Game_Recorder* recorder, bool with_scores = false) {
+            this->recorder = recorder;
+            record_scores = with_scores;
+        }
+
+        /**
+         * @brief Sets the seed stored with the next game record, so a game can be found and played again
+        */
+        void set_seed(uint64_t seed) { this->seed = seed; }
 
         Game_Results play() {
             restart();
 
             Game_Results results;
             results.think_time = think_time_ms;
-            string AI_Move;
+            Move AI_Move;
             Timer timer(think_time_ms);
-            int turn_count = 0;
             double duration = 0;
+            bool forfeit = false;
+            default_rng = seed; // A game's default moves follow from its seed, like everything else in its record
+
+            // Filled in as the game is played, appending a move allocates nothing
+            Game_Record record;
+            if(recorder != nullptr) {
+                record.clear(record_scores);
+                record.P1_name = P1_AI->name();
+                record.P2_name = P2_AI->name();
+                record.think_time = think_time_ms;
+                record.seed = seed;
+            }
 
-            while(!is_game_over()) {
-                queue<string> moves;
-                compute_moves(moves);
-
-                timer.start();
-                AI_Move = (next_mover() == P1 ? P1_AI->think(moves, timer) : P2_AI->think(moves, timer));
-                timer.stop();
+            // Enforced, each AI thinks on its own worker against its own copy of the game, so a think
+            // that overruns can keep reading it while the game moves on
+            Boop P1_view(*this);
+            Boop P2_view(*this);
+            Think_Worker P1_worker(think_time_ms);
+            Think_Worker P2_worker(think_time_ms);
+            if(policy.enforce) {
+                P1_AI->set_game(&P1_view);
+                P2_AI->set_game(&P2_view);
+            }
 
-                duration += timer.elapsedMilliseconds();
+            while(!is_game_over() && turn_count < turn_limit*2) {
+                MoveList moves;
+                compute_moves(moves);
+                double think_ms;
+                Search_Totals& search = (next_mover() == P1 ? results.P1_search : results.P2_search);
+                Search_Stats stats;
+                bool reported;
+
+                if(policy.enforce) {
+                    Overrun_Totals& overruns = (next_mover() == P1 ? results.P1_overruns : results.P2_overruns);
+                    AI_Move = (next_mover() == P1 ? enforced_think(P1_AI, P1_worker, P1_view, moves, stats, reported, overruns, think_ms)
+                                                  : enforced_think(P2_AI, P2_worker, P2_view, moves, stats, reported, overruns, think_ms));
+                    if(policy.forfeit_after > 0 && overruns.overruns >= policy.forfeit_after) {
+                        overruns.forfeited = true;
+                        forfeit = true;
+                    }
+                } else {
+                    timer.start();
+                    AI_Move = (next_mover() == P1 ? P1_AI->think(moves, timer) : P2_AI->think(moves, timer));
+                    timer.stop();
+                    think_ms = timer.elapsedMilliseconds();
+                    reported = (next_mover() == P1 ? P1_AI->search_stats(stats) : P2_AI->search_stats(stats));
+                }
+                if(reported) { search.add(stats); }
 
+                duration += think_ms;
                 if(next_mover() == P1) {
-                    results.P1_avg_think_time += timer.elapsedMilliseconds();
+                    results.P1_avg_think_time += think_ms;
                 } else {
-                    results.P2_avg_think_time += timer.elapsedMilliseconds();
+                    results.P2_avg_think_time += think_ms;
                 }
 
-                make_move(AI_Move);
+                if(forfeit) {
+                    results.winner = opposite(next_mover());
+                    break;
+                }
 
-                if(++turn_count >= turn_limit*2) { 
-                    results.num_moves = turn_limit;
-                    results.duration = duration;
-                    results.P1_avg_think_time /= results.num_moves;
-                    results.P2_avg_think_time /= results.num_moves;
-                    return results;
+                if(recorder != nullptr) {
+                    record.add_move(AI_Move, think_ms, reported && stats.has_score ? stats.score : Game_Record::NO_SCORE);
                 }
+                make_move(AI_Move);
+                ++turn_count;
             }
+
+            // A think abandoned at its deadline has to return before its AI can play another game
+            P1_worker.finish();
+            P2_worker.finish();
+            P1_AI->set_game(this);
+            P2_AI->set_game(this);
+
             results.num_moves = turn_count / 2;
             results.duration = duration;
-            results.P1_avg_think_time /= results.num_moves;
-            results.P2_avg_think_time /= results.num_moves;
-            results.winner = winning();
+            if(results.num_moves > 0) {
+                results.P1_avg_think_time /= results.num_moves;
+                results.P2_avg_think_time /= results.num_moves;
+            }
+            if(!forfeit && turn_count < turn_limit*2) { results.winner = winning(); }
+
+            if(recorder != nullptr) {
+                record.winner = results.winner;
+                recorder->write(record);
+            }
 
             return results;
         }
 
+        /**
+         * @brief Applies a move for the current player
+         * @param move The move to play, either packed or in string form (e.g., "bc4")
+         *
+         * @return An undo record that unmake_move can use to take the move back
+        */
+        Undo make_move(Move move);
         void make_move(const string& move);
+
+        /**
+         * @brief Takes back the last move made, restoring the exact game state from before it
+         * @param undo The record returned by the make_move call being taken back
+         *
+         * @note Moves must be taken back in the reverse order they were made
+        */
+        void unmake_move(const Undo& undo);
         
         // Accessible with Game Ref
         /**
@@ -107,6 +291,11 @@ class Boop {
          * @return An integer representing the number of rounds played
         */
         int moves_completed( ) const;
+
+        /**
+         * @brief The number of moves play() has made this game, removals included, the count turn_limit is checked against
+        */
+        int moves_played() const { return turn_count; }
         
         /**
          * @brief The last player that moved
@@ -146,6 +335,13 @@ class Boop {
         */
         Boop* clone() const;
 
+        /**
+         * @brief The current game state, copy it to search ahead without touching the game
+         * 
+         * @return A reference to the game Position
+        */
+        const Position& position() const;
+
         /**
          * @brief Clones the current boop game board
          * 
@@ -155,8 +351,9 @@ class Boop {
 
         /**
          * @brief Generates all possible legal moves for the given board state
-         * @param moves A queue reference for the function to fill with legal moves
+         * @param moves A move list or queue reference for the function to fill with legal moves
         */
+        void compute_moves(MoveList& moves) const;
         void compute_moves(queue<string>& moves) const;
 
         /**
@@ -168,10 +365,11 @@ class Boop {
 
         /**
          * @brief Determines if the move provided is legal
-         * @param move A string reference of the move to check
+         * @param move The move to check, either packed or in string form
          * 
          * @return A bool indicating move legality
         */
+        bool is_legal(Move move) const;
         bool is_legal(const string& move) const;
 
         /**
@@ -242,57 +440,55 @@ class Boop {
         */
         int count_tri_pattern(PieceType type = NONE) const;
 
+        /**
+         * @brief A 64 bit Zobrist hash identifying the current game state
+         * 
+         * @return The same key for any two games with the same pieces, reserves, move state and player to move
+        */
+        uint64_t hash() const;
+
         void display_status() const;
 
     private:
         friend class AI;
 
-        const int CENTER_INCENTIVE[SIZE][SIZE] ={{ 1, 2, 4, 4, 2, 1},
-                                                { 2, 5, 7, 7, 5, 2},
-                                                { 4, 7,10,10, 7, 4},
-                                                { 4, 7,10,10, 7, 4},
-                                                { 2, 5, 7, 7, 5, 2},
-                                                { 1, 2, 4, 4, 2, 1}};
-        const string ALL_MOVES[72] = {"ba1","ba2","ba3","ba4","ba5","ba6",
-                                      "bb1","bb2","bb3","bb4","bb5","bb6",
-                                      "bc1","bc2","bc3","bc4","bc5","bc6",
-                                      "bd1","bd2","bd3","bd4","bd5","bd6",
-                                      "be1","be2","be3","be4","be5","be6",
-                                      "bf1","bf2","bf3","bf4","bf5","bf6",
-                                      "ra1","ra2","ra3","ra4","ra5","ra6",
-                                      "rb1","rb2","rb3","rb4","rb5","rb6",
-                                      "rc1","rc2","rc3","rc4","rc5","rc6",
-                                      "rd1","rd2","rd3","rd4","rd5","rd6",
-                                      "re1","re2","re3","re4","re5","re6",
-                                      "rf1","rf2","rf3","rf4","rf5","rf6" };
-
         // Game State Items
-        PieceType board[SIZE][SIZE];
-        MoveState move_state = MAKE_MOVE;
-        int move_number;
-        int P1_kit_pieces;
-        int P1_cat_pieces;
-        int P2_kit_pieces;
-        int P2_cat_pieces;
+        Position state;
 
         // AI Items
         AI* P1_AI = nullptr;
         AI* P2_AI = nullptr;
         double think_time_ms;
-        const int turn_limit = 300;
+        Deadline_Policy policy;
+        int turn_count = 0;                 // Moves made by play() this game
+
+        // Game recording
+        Game_Recorder* recorder = nullptr;
+        bool record_scores = false;
+        uint64_t seed = 0;
+        uint64_t default_rng = 0;           // Picks random default moves, restarted from seed by each play()
 
         // Human display Items
-        string P1_Color = MAGENTA;
-        string P2_Color = GREEN;
+        static const string P1_Color;
+        static const string P2_Color;
 
         // Private functions
         void restart();
         int evaluate() const;
 
-        // Helper Functions
-        bool can_boop(char type, PieceType enum_type) const;
-        void return_piece(int x, int y, bool promote = false);
-        void boop_adjacent_pieces(char type, int x, int y);
+        /**
+         * @brief Runs one think on a worker and waits for it no longer than the think time and the grace
+         * @param stats Filled in with what the think searched, if it returned in time
+         * @param reported Set to whether stats was filled in
+         * @param think_ms Set to how long the move took, up to when it was played
+         *
+         * @return The move think returned, or if it is still running the move it published, or the default move
+        */
+        Move enforced_think(AI* ai, Think_Worker& worker, Boop& view, const MoveList& moves,
+                            Search_Stats& stats, bool& reported, Overrun_Totals& overruns, double& think_ms);
+
+        // The move played for an AI that has nothing legal to offer
+        Move default_move(const MoveList& moves, Overrun_Totals& overruns);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+/**
+*    @file: dataset.cc
+*   @brief: Writing and reading self-play dataset files
+*
+*/
+
+#include "dataset.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char DATA_MAGIC[8] = { 'B', 'O', 'O', 'P', 'D', 'A', 'T', 'A' };
+static const uint32_t DATA_VERSION = 1;
+static const size_t HEADER_SIZE = 16;
+
+/// SAMPLES
+Dataset_Sample Dataset_Sample::from(const Position& position, int score, int result, int depth) {
+    Dataset_Sample sample = {};
+    for(int i = 0; i < 4; ++i) {
+        Boop_Types::PieceType type = (Boop_Types::PieceType) (i + 1);
+        sample.pieces[i] = position.pieces_of(type);
+    }
+    sample.reserve[Boop_Types::P1_KIT - 1] = position.kittens(Boop_Types::P1);
+    sample.reserve[Boop_Types::P1_CAT - 1] = position.cats(Boop_Types::P1);
+    sample.reserve[Boop_Types::P2_KIT - 1] = position.kittens(Boop_Types::P2);
+    sample.reserve[Boop_Types::P2_CAT - 1] = position.cats(Boop_Types::P2);
+    sample.move_number = position.moves_completed();
+    sample.move_state = position.move_type();
+    sample.result = result;
+    sample.score = std::min(std::max(score, -32767), 32767);
+    sample.depth = std::min(std::max(depth, 0), 255);
+    return sample;
+}
+
+Position Dataset_Sample::position() const {
+    return Position(pieces, reserve, (Boop_Types::MoveState) move_state, move_number);
+}
+
+/// WRITER
+bool Dataset_Writer::open(const std::string& path, bool append) {
+    close();
+
+    char header[HEADER_SIZE];
+    uint32_t version = DATA_VERSION;
+    uint32_t sample_size = sizeof(Dataset_Sample);
+    memcpy(header, DATA_MAGIC, sizeof(DATA_MAGIC));
+    memcpy(header + 8, &version, 4);
+    memcpy(header + 12, &sample_size, 4);
+
+    if(append) {
+        // Only add to a file with the same layout, and drop any sample cut off partway through being written
+        file = fopen(path.c_str(), "r+b");
+        if(file != nullptr) {
+            char existing[HEADER_SIZE];
+            struct stat status;
+            if(fread(existing, 1, HEADER_SIZE, file) != HEADER_SIZE || memcmp(existing, header, HEADER_SIZE) != 0
+               || fstat(fileno(file), &status) != 0) {
+                close();
+                return false;
+            }
+            size_t whole = (status.st_size - HEADER_SIZE) / sizeof(Dataset_Sample);
+            off_t end = HEADER_SIZE + whole * sizeof(Dataset_Sample);
+            if(end != status.st_size && ftruncate(fileno(file), end) != 0) {
+                close();
+                return false;
+            }
+            fseeko(file, end, SEEK_SET);
+            setvbuf(file, nullptr, _IOFBF, BUFFER_SIZE);
+            samples_written = 0;
+            failed = false;
+            return true;
+        }
+    }
+
+    file = fopen(path.c_str(), "wb");
+    if(file == nullptr) { return false; }
+    setvbuf(file, nullptr, _IOFBF, BUFFER_SIZE);
+    // Flushed now, so a file that can't be written fails here rather than at the first batch
+    if(fwrite(header, HEADER_SIZE, 1, file) != 1 || fflush(file) != 0) {
+        close();
+        return false;
+    }
+    samples_written = 0;
+    failed = false;
+    return true;
+}
+
+bool Dataset_Writer::close() {
+    if(file != nullptr && fclose(file) != 0) { failed = true; }
+    file = nullptr;
+    return !failed;
+}
+
+bool Dataset_Writer::write(const Dataset_Sample* samples, size_t count) {
+    std::lock_guard<std::mutex> guard(lock);
+    if(file == nullptr || failed) { return false; }
+    // Once a write comes up short (a full disk) nothing more is added, the reader drops a partial sample
+    size_t written = fwrite(samples, sizeof(Dataset_Sample), count, file);
+    samples_written += written;
+    if(written != count) { failed = true; }
+    return !failed;
+}
+
+/// READER
+bool Dataset_Reader::open(const std::string& path) {
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0) { return false; }
+    struct stat status;
+    if(fstat(file, &status) != 0 || (size_t) status.st_size < HEADER_SIZE) {
+        ::close(file);
+        return false;
+    }
+
+    void* map = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if(map == MAP_FAILED) { return false; }
+
+    uint32_t version, sample_size;
+    memcpy(&version, (const char*) map + 8, 4);
+    memcpy(&sample_size, (const char*) map + 12, 4);
+    if(memcmp(map, DATA_MAGIC, sizeof(DATA_MAGIC)) != 0 || version != DATA_VERSION || sample_size != sizeof(Dataset_Sample)) {
+        munmap(map, status.st_size);
+        return false;
+    }
+
+    mapping = map;
+    mapping_size = status.st_size;
+    samples = (const Dataset_Sample*) ((const char*) map + HEADER_SIZE);
+    count = (mapping_size - HEADER_SIZE) / sizeof(Dataset_Sample);
+    return true;
+}
+
+void Dataset_Reader::close() {
+    if(mapping != nullptr) { munmap(mapping, mapping_size); }
+    mapping = nullptr;
+    mapping_size = 0;
+    samples = nullptr;
+    count = 0;
+}
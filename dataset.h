@@ -0,0 +1,121 @@
+/**
+*    @file: dataset.h
+*   @brief: Positions from self-play games, each with the score the mover's search gave it and how the game
+*           ended, for fitting evaluation weights to (tools/selfplay.cc writes them). Every sample is the same
+*           size, so a Dataset_Reader maps the file and hands it out as a plain array that tools can scan
+*           at memory speed, or split between threads by index.
+*
+*           File layout (little endian): an 8 byte magic "BOOPDATA", a uint32 version and a uint32 sample
+*           size, then the samples back to back until the end of the file.
+*
+*/
+
+#ifndef DATASET_H
+#define DATASET_H
+
+#include "position.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+// One sampled position, 48 bytes
+struct Dataset_Sample {
+    uint64_t pieces[4];                 // Position::pieces_of(), indexed by (PieceType - 1)
+    int8_t reserve[4];                  // Pieces off the board, indexed by (PieceType - 1)
+    uint16_t move_number;               // Position::moves_completed()
+    uint8_t move_state;                 // Boop_Types::MoveState
+    int8_t result;                      // How the game ended for the player to move: 1 won, 0 tied, -1 lost
+    int16_t score;                      // The player to move's search score, in the searching AI's units
+    uint8_t depth;                      // How deep the search that gave the score went, 0 if unknown
+    uint8_t padding[5];
+
+    static Dataset_Sample from(const Position& position, int score, int result, int depth = 0);
+
+    Position position() const;
+    Boop_Types::who next_mover() const { return move_number % 2 == 0 ? Boop_Types::P1 : Boop_Types::P2; }
+};
+
+static_assert(sizeof(Dataset_Sample) == 48, "Dataset files depend on the sample layout");
+
+// Appends samples to a dataset file, one buffered write per batch under a lock
+class Dataset_Writer {
+    public:
+        Dataset_Writer() { }
+        ~Dataset_Writer() { close(); }
+
+        Dataset_Writer(const Dataset_Writer&) = delete;
+        Dataset_Writer& operator = (const Dataset_Writer&) = delete;
+
+        /**
+         * @brief Creates a dataset file, or adds to the end of one
+         * @param path The file
+         * @param append Keep the samples already in the file
+         *
+         * @return A bool indicating if the file could be opened, and if appending, is a dataset
+        */
+        bool open(const std::string& path, bool append = false);
+
+        /**
+         * @brief Flushes the buffer and closes the file
+         * @return A bool indicating if every sample since open() made it into the file
+        */
+        bool close();
+
+        /**
+         * @brief Appends samples, safe to call from several threads at once
+         * @param samples The samples, written together
+         * @param count How many there are
+         *
+         * @return A bool indicating if they were written, false once any write has failed
+        */
+        bool write(const Dataset_Sample* samples, size_t count);
+
+        // True once a write has failed, later samples are dropped
+        bool has_failed() const { return failed; }
+
+        /**
+         * @brief The number of samples written since the file was opened
+        */
+        long long samples() const { return samples_written; }
+
+    private:
+        static const size_t BUFFER_SIZE = 1 << 20;
+
+        FILE* file = nullptr;
+        std::mutex lock;
+        std::atomic<long long> samples_written{0};
+        std::atomic<bool> failed{false};
+};
+
+// Maps a dataset file read only, the samples are an array in the mapping
+class Dataset_Reader {
+    public:
+        Dataset_Reader() { }
+        ~Dataset_Reader() { close(); }
+
+        Dataset_Reader(const Dataset_Reader&) = delete;
+        Dataset_Reader& operator = (const Dataset_Reader&) = delete;
+
+        /**
+         * @brief Maps a dataset file, closing any that was open
+         * @return A bool indicating if the file exists and is a dataset
+        */
+        bool open(const std::string& path);
+        void close();
+
+        size_t size() const { return count; }
+        const Dataset_Sample& operator [] (size_t i) const { return samples[i]; }
+        const Dataset_Sample* begin() const { return samples; }
+        const Dataset_Sample* end() const { return samples + count; }
+
+    private:
+        void* mapping = nullptr;
+        size_t mapping_size = 0;
+        const Dataset_Sample* samples = nullptr;
+        size_t count = 0;
+};
+
+#endif
@@ -0,0 +1,179 @@
+/**
+*    @file: evaluator.cc
+*   @brief: The single pass evaluation shared by Boop and the AIs
+*
+*/
+
+#include "evaluator.h"
+#include "bitboard.h"
+#include <fstream>
+using namespace bitboard;
+
+const Eval_Weights::Field Eval_Weights::FIELDS[] = {
+    { "reserve_kitten", &Eval_Weights::reserve_kitten, nullptr },
+    { "reserve_cat", &Eval_Weights::reserve_cat, nullptr },
+    { "board_kitten", &Eval_Weights::board_kitten, nullptr },
+    { "board_cat", &Eval_Weights::board_cat, nullptr },
+    { "center", &Eval_Weights::center, nullptr },
+    { "cat_tri", &Eval_Weights::cat_tri, nullptr },
+    { "cat_tri_bonus", &Eval_Weights::cat_tri_bonus, nullptr },
+    { "kitten_tri", &Eval_Weights::kitten_tri, nullptr },
+    { "kitten_tri_bonus", &Eval_Weights::kitten_tri_bonus, nullptr },
+    { "friendly_tri", &Eval_Weights::friendly_tri, nullptr },
+    { "friendly_tri_bonus", &Eval_Weights::friendly_tri_bonus, nullptr },
+    { "kitten_pair", &Eval_Weights::kitten_pair, nullptr },
+    { "kitten_pair_bonus", &Eval_Weights::kitten_pair_bonus, nullptr },
+    { "pairs_exclude_threes", nullptr, &Eval_Weights::pairs_exclude_threes },
+    { "kitten_three", &Eval_Weights::kitten_three, nullptr },
+    { "kitten_three_bonus", &Eval_Weights::kitten_three_bonus, nullptr },
+    { "cat_pair", &Eval_Weights::cat_pair, nullptr },
+    { "cat_pair_bonus", &Eval_Weights::cat_pair_bonus, nullptr },
+    { "cat_pair_contested_bonus", &Eval_Weights::cat_pair_contested_bonus, nullptr },
+    { "bonus_to_next_mover", nullptr, &Eval_Weights::bonus_to_next_mover },
+    { "win", &Eval_Weights::win, nullptr },
+};
+
+const int Eval_Weights::FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+bool Eval_Weights::load(const std::string& path) {
+    std::ifstream file(path);
+    if(!file) { return false; }
+
+    // Read into a copy, so a bad file changes nothing
+    Eval_Weights loaded = *this;
+    std::string name;
+    int value;
+    while(file >> name >> value) {
+        const Field* field = nullptr;
+        for(int i = 0; i < FIELD_COUNT; ++i) {
+            if(name == FIELDS[i].name) { field = &FIELDS[i]; }
+        }
+        if(field == nullptr) { return false; }
+        if(field->number != nullptr) { loaded.*(field->number) = value; }
+        else { loaded.*(field->flag) = value != 0; }
+    }
+    if(!file.eof()) { return false; }
+
+    *this = loaded;
+    return true;
+}
+
+bool Eval_Weights::save(const std::string& path) const {
+    std::ofstream file(path);
+    for(int i = 0; i < FIELD_COUNT; ++i) {
+        const Field& field = FIELDS[i];
+        file << field.name << " " << (field.number != nullptr ? this->*(field.number) : (int) (this->*(field.flag))) << "\n";
+    }
+    return (bool) file;
+}
+
+// Bit k of a squares CENTER_INCENTIVE, as a mask over the board, so center control is a handful of popcounts
+struct Center_Layers {
+    uint64_t layer[4];
+};
+
+constexpr Center_Layers make_center_layers() {
+    Center_Layers layers = {};
+    for(int y = 0; y < SIZE; ++y) {
+        for(int x = 0; x < SIZE; ++x) {
+            for(int k = 0; k < 4; ++k) {
+                if(Position::CENTER_INCENTIVE[x][y] >> k & 1) { layers.layer[k] |= 1ULL << (y * SIZE + x); }
+            }
+        }
+    }
+    return layers;
+}
+
+constexpr Center_Layers CENTER_LAYERS = make_center_layers();
+
+// Counts two and three in a rows of the pieces, each direction walked once for both lengths
+void count_rows(uint64_t mine, int& pairs, int& threes) {
+    uint64_t east = mine & look<1, 0>(mine);
+    uint64_t south_east = mine & look<1, -1>(mine);
+    uint64_t south = mine & look<0, -1>(mine);
+    uint64_t south_west = mine & look<-1, -1>(mine);
+    pairs = popcount(east) + popcount(south_east) + popcount(south) + popcount(south_west);
+    threes = popcount(east & look<2, 0>(mine)) + popcount(south_east & look<2, -2>(mine)) +
+             popcount(south & look<0, -2>(mine)) + popcount(south_west & look<-2, -2>(mine));
+}
+
+void Evaluator::material_features(const Position& position, Eval_Features& f) {
+    f.next_mover = position.next_mover();
+    for(int p = 0; p < 2; ++p) {
+        Boop_Types::who player = (p == 0 ? Boop_Types::P1 : Boop_Types::P2);
+        uint64_t kittens = position.pieces_of(p == 0 ? Boop_Types::P1_KIT : Boop_Types::P2_KIT);
+        uint64_t cats = position.pieces_of(p == 0 ? Boop_Types::P1_CAT : Boop_Types::P2_CAT);
+        uint64_t all = kittens | cats;
+
+        f.reserve_kittens[p] = position.kittens(player);
+        f.reserve_cats[p] = position.cats(player);
+        f.board_kittens[p] = popcount(kittens);
+        f.board_cats[p] = popcount(cats);
+        f.center[p] = 0;
+        for(int k = 0; k < 4; ++k) { f.center[p] += popcount(all & CENTER_LAYERS.layer[k]) << k; }
+        f.eight_cats_down[p] = f.reserve_kittens[p] == 0 && f.reserve_cats[p] == 0 && kittens == 0;
+    }
+}
+
+Eval_Features Evaluator::features(const Position& position) {
+    Eval_Features f;
+    material_features(position, f);
+    f.friendly_tris = count_friendly_tri_pattern(position.friends());
+
+    for(int p = 0; p < 2; ++p) {
+        uint64_t kittens = position.pieces_of(p == 0 ? Boop_Types::P1_KIT : Boop_Types::P2_KIT);
+        uint64_t cats = position.pieces_of(p == 0 ? Boop_Types::P1_CAT : Boop_Types::P2_CAT);
+
+        f.cat_tris[p] = count_tri_pattern(cats);
+        f.kitten_tris[p] = count_tri_pattern(kittens);
+        count_rows(kittens, f.kitten_pairs[p], f.kitten_threes[p]);
+        int cat_threes;
+        count_rows(cats, f.cat_pairs[p], cat_threes);
+        f.cat_threes[p] = cat_threes > 0;
+    }
+    return f;
+}
+
+int Evaluator::score(const Eval_Features& f) const {
+    const Eval_Weights& w = weights;
+    int next = (f.next_mover == Boop_Types::P1 ? 0 : 1);
+    int bonus_player = w.bonus_to_next_mover ? next : 1 - next;
+
+    // Return neg if P1 is winning
+    // Return pos if P2 is winning
+    int eval = 0;
+    for(int p = 0; p < 2; ++p) {
+        bool bonus = (p == bonus_player);
+        int term = 0;
+
+        /// MATERIAL ADVANTAGE EVALUATION
+        term += f.reserve_kittens[p] * w.reserve_kitten + f.reserve_cats[p] * w.reserve_cat;
+        term += f.board_kittens[p] * w.board_kitten + f.board_cats[p] * w.board_cat;
+        term += f.center[p] * w.center;
+
+        /// POSITIONAL ADVANTAGE EVALUATION
+        term += f.cat_tris[p] * w.cat_tri * (bonus ? w.cat_tri_bonus : 1);
+        term += f.kitten_tris[p] * w.kitten_tri * (bonus ? w.kitten_tri_bonus : 1);
+        term += f.friendly_tris * w.friendly_tri * (bonus ? w.friendly_tri_bonus : 1);
+
+        int kitten_pairs = f.kitten_pairs[p] - (w.pairs_exclude_threes ? f.kitten_threes[p] * 2 : 0);
+        term += kitten_pairs * w.kitten_pair * (bonus ? w.kitten_pair_bonus : 1);
+        term += f.kitten_threes[p] * w.kitten_three * (bonus ? w.kitten_three_bonus : 1);
+
+        int cat_pair_bonus = 1;
+        if(bonus && f.reserve_cats[p] > 0) {
+            cat_pair_bonus = f.reserve_cats[1 - p] > 0 ? w.cat_pair_contested_bonus : w.cat_pair_bonus;
+        }
+        term += f.cat_pairs[p] * w.cat_pair * cat_pair_bonus;
+
+        eval += (p == 0 ? -term : term);
+    }
+
+    // Winning Conditions - Give huge rewards, later checks take priority
+    eval = (f.cat_threes[0] ? -w.win : eval);
+    eval = (f.cat_threes[1] ?  w.win : eval);
+    eval = (f.eight_cats_down[0] ? -w.win : eval);
+    eval = (f.eight_cats_down[1] ?  w.win : eval);
+
+    return eval;
+}
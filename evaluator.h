@@ -0,0 +1,147 @@
+/**
+*    @file: evaluator.h
+*   @brief: The evaluation function shared by Boop and the AIs. Every term is gathered from the bitboards in a
+*           single pass, then weighted by an Eval_Weights, so AIs that want a different style of play only
+*           change the weights.
+*
+*/
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "position.h"
+#include <string>
+
+/**
+ * The weight of each evaluation term. Pattern terms have a bonus that multiplies them for the bonus player,
+ * which is the player who just moved unless bonus_to_next_mover is set.
+*/
+struct Eval_Weights {
+    // Material, pieces in reserve and on the board
+    int reserve_kitten = 2;
+    int reserve_cat = 40;
+    int board_kitten = 0;
+    int board_cat = 0;
+    int center = 0;                     // Times the Position::CENTER_INCENTIVE of each square a piece is on
+
+    // Patterns
+    int cat_tri = 10;                   // 3x3 sub grids with three rabbits in the corners
+    int cat_tri_bonus = 8;
+    int kitten_tri = 15;                // 3x3 sub grids with three bunnies in the corners
+    int kitten_tri_bonus = 8;
+    int friendly_tri = 5;               // 3x3 sub grids with three of the player to moves pieces in the corners
+    int friendly_tri_bonus = 4;
+    int kitten_pair = 5;                // Two bunnies in a row
+    int kitten_pair_bonus = 8;
+    bool pairs_exclude_threes = false;  // Each three in a row is two pairs, take them back out
+    int kitten_three = 10;              // Three bunnies in a row
+    int kitten_three_bonus = 8;
+    int cat_pair = 15;                  // Two rabbits in a row
+    int cat_pair_bonus = 2;             // While the bonus player has rabbits in reserve and the other player does not
+    int cat_pair_contested_bonus = 1;   // While both players have rabbits in reserve
+
+    bool bonus_to_next_mover = false;
+    int win = 9999;                     // Three rabbits in a row or all eight rabbits on the board
+
+    // One weight by name, either a number or a flag, for reading and writing weights files
+    struct Field {
+        const char* name;
+        int Eval_Weights::* number;
+        bool Eval_Weights::* flag;
+    };
+    static const Field FIELDS[];
+    static const int FIELD_COUNT;
+
+    /**
+     * @brief Reads a weights file, one "name value" line per weight, as written by save() or tools/tune.cc
+     * @param path The file
+     *
+     * @return A bool indicating if the file could be read and every name in it is a weight. Weights the
+     *         file leaves out keep their value.
+    */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Writes every weight to a file that load() reads
+     * @return A bool indicating if the file was written
+    */
+    bool save(const std::string& path) const;
+
+    // The weights Boop::evaluate uses
+    static Eval_Weights boop() {
+        Eval_Weights weights;
+        weights.board_kitten = 3;
+        weights.board_cat = 45;
+        weights.center = 1;
+        return weights;
+    }
+
+    // The weights Eval_AI uses, the Boop weights without board material or center control
+    static Eval_Weights lookahead() { return Eval_Weights(); }
+
+    // The weights the alpha beta AIs use, with bigger bonuses for the player to move
+    static Eval_Weights alpha_beta() {
+        Eval_Weights weights;
+        weights.pairs_exclude_threes = true;
+        weights.kitten_three_bonus = 16;
+        weights.cat_pair_bonus = 4;
+        weights.cat_pair_contested_bonus = 2;
+        weights.bonus_to_next_mover = true;
+        return weights;
+    }
+};
+
+/**
+ * Every count the evaluation is made from, indexed by player (0 for P1, 1 for P2) where it is per player
+*/
+struct Eval_Features {
+    int reserve_kittens[2];
+    int reserve_cats[2];
+    int board_kittens[2];
+    int board_cats[2];
+    int center[2];
+    int cat_tris[2];
+    int kitten_tris[2];
+    int friendly_tris;                  // Only counted for the player to move
+    int kitten_pairs[2];
+    int kitten_threes[2];
+    int cat_pairs[2];
+    bool cat_threes[2];
+    bool eight_cats_down[2];
+    Boop_Types::who next_mover;
+};
+
+class Evaluator {
+    public:
+        explicit Evaluator(const Eval_Weights& weights = Eval_Weights()) : weights(weights) { }
+
+        /**
+         * @brief Scores a position
+         * @return Negative if P1 is winning and positive if P2 is winning
+        */
+        int evaluate(const Position& position) const { return score(features(position)); }
+
+        /**
+         * @brief Collects every count the evaluation needs in one pass over the bitboards
+        */
+        static Eval_Features features(const Position& position);
+
+        /**
+         * @brief Fills in the features that are not patterns: the player to move, material, center control
+         *        and whether a player has all eight rabbits down
+        */
+        static void material_features(const Position& position, Eval_Features& features);
+
+        /**
+         * @brief Weights the features of a position
+         * @return Negative if P1 is winning and positive if P2 is winning
+        */
+        int score(const Eval_Features& features) const;
+
+        const Eval_Weights& get_weights() const { return weights; }
+
+    private:
+        Eval_Weights weights;
+};
+
+#endif
@@ -0,0 +1,155 @@
+/**
+*    @file: game_record.cc
+*   @brief: Writing and reading game record files
+*
+*/
+
+#include "game_record.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char GAME_MAGIC[8] = { 'B', 'O', 'O', 'P', 'G', 'A', 'M', 'E' };
+static const uint32_t GAME_VERSION = 1;
+static const uint8_t HAS_SCORES = 1;
+
+// The fixed part of each game entry, after its size
+static const size_t FIXED_SIZE = 1 + 1 + 2 + 4 + 8;
+
+/// WRITER
+bool Game_Writer::open(const std::string& path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if(file == nullptr) { return false; }
+    setvbuf(file, nullptr, _IOFBF, BUFFER_SIZE);
+
+    // Flushed now, so a file that can't be written fails here rather than at the first game
+    uint32_t header[2] = { GAME_VERSION, 0 };
+    if(fwrite(GAME_MAGIC, sizeof(GAME_MAGIC), 1, file) != 1 || fwrite(header, sizeof(header), 1, file) != 1 || fflush(file) != 0) {
+        close();
+        return false;
+    }
+    games_written = 0;
+    failed = false;
+    return true;
+}
+
+bool Game_Writer::close() {
+    if(file != nullptr && fclose(file) != 0) { failed = true; }
+    file = nullptr;
+    return !failed;
+}
+
+void Game_Writer::write(const Game_Record& game) {
+    // The whole entry goes together into the file buffer, so games from different threads never interleave
+    uint8_t P1_length = (uint8_t) std::min((int) game.P1_name.size(), Game_Record::MAX_NAME);
+    uint8_t P2_length = (uint8_t) std::min((int) game.P2_name.size(), Game_Record::MAX_NAME);
+    uint16_t move_count = (uint16_t) game.move_count;
+    size_t column = 2 * (size_t) move_count;
+    uint32_t size = FIXED_SIZE + 1 + P1_length + 1 + P2_length + column * (game.scores_kept ? 3 : 2);
+
+    char fixed[4 + FIXED_SIZE];
+    uint8_t flags = game.scores_kept ? HAS_SCORES : 0;
+    memcpy(fixed, &size, 4);
+    memcpy(fixed + 4, &game.winner, 1);
+    memcpy(fixed + 5, &flags, 1);
+    memcpy(fixed + 6, &move_count, 2);
+    memcpy(fixed + 8, &game.think_time, 4);
+    memcpy(fixed + 12, &game.seed, 8);
+
+    std::lock_guard<std::mutex> guard(lock);
+    if(file == nullptr || failed) { return; }
+    // Once a write comes up short (a full disk) nothing more is added, the reader stops at a partial game
+    bool written = fwrite(fixed, sizeof(fixed), 1, file) == 1
+                && fwrite(&P1_length, 1, 1, file) == 1
+                && fwrite(game.P1_name.data(), 1, P1_length, file) == P1_length
+                && fwrite(&P2_length, 1, 1, file) == 1
+                && fwrite(game.P2_name.data(), 1, P2_length, file) == P2_length
+                && fwrite(game.moves, 1, column, file) == column
+                && fwrite(game.think, 1, column, file) == column
+                && (!game.scores_kept || fwrite(game.scores, 1, column, file) == column);
+    if(!written) {
+        failed = true;
+        return;
+    }
+    games_written++;
+}
+
+/// READER
+bool Game_Reader::open(const std::string& path) {
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0) { return false; }
+    struct stat status;
+    if(fstat(file, &status) != 0 || (size_t) status.st_size < sizeof(GAME_MAGIC) + 8) {
+        ::close(file);
+        return false;
+    }
+
+    void* map = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if(map == MAP_FAILED) { return false; }
+
+    uint32_t version;
+    memcpy(&version, (const char*) map + sizeof(GAME_MAGIC), 4);
+    if(memcmp(map, GAME_MAGIC, sizeof(GAME_MAGIC)) != 0 || version != GAME_VERSION) {
+        munmap(map, status.st_size);
+        return false;
+    }
+
+    // Games are read front to back, once
+    madvise(map, status.st_size, MADV_SEQUENTIAL);
+    mapping = map;
+    mapping_size = status.st_size;
+    offset = sizeof(GAME_MAGIC) + 8;
+    return true;
+}
+
+void Game_Reader::close() {
+    if(mapping != nullptr) { munmap(mapping, mapping_size); }
+    mapping = nullptr;
+    mapping_size = 0;
+    offset = 0;
+}
+
+bool Game_Reader::next(Game& game) {
+    const char* data = (const char*) mapping;
+    if(mapping == nullptr || offset + 4 + FIXED_SIZE > mapping_size) { return false; }
+
+    uint32_t size;
+    memcpy(&size, data + offset, 4);
+    size_t end = offset + 4 + size;
+    if(size < FIXED_SIZE + 2 || end > mapping_size) { return false; } // A game cut off partway through being written
+
+    const char* entry = data + offset + 4;
+    uint8_t flags;
+    uint16_t move_count;
+    memcpy(&game.winner, entry, 1);
+    memcpy(&flags, entry + 1, 1);
+    memcpy(&move_count, entry + 2, 2);
+    memcpy(&game.think_time, entry + 4, 4);
+    memcpy(&game.seed, entry + 8, 8);
+
+    // Every length is checked against the entry before it is used, so a damaged file is never read past
+    const char* names = entry + FIXED_SIZE;
+    uint8_t P1_length = (uint8_t) names[0];
+    if(FIXED_SIZE + 2 + (size_t) P1_length > size) { return false; }
+    uint8_t P2_length = (uint8_t) names[1 + P1_length];
+    size_t names_size = 2 + (size_t) P1_length + P2_length;
+    size_t column = 2 * (size_t) move_count;
+    if(FIXED_SIZE + names_size + column * ((flags & HAS_SCORES) ? 3 : 2) > size) { return false; }
+
+    game.P1_length = P1_length;
+    game.P1 = names + 1;
+    game.P2_length = P2_length;
+    game.P2 = names + 2 + P1_length;
+    game.move_count = move_count;
+    game.moves = names + names_size;
+    game.think = game.moves + column;
+    game.scores = (flags & HAS_SCORES) ? game.think + column : nullptr;
+
+    offset = end;
+    return true;
+}
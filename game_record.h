@@ -0,0 +1,206 @@
+/**
+*    @file: game_record.h
+*   @brief: A compact binary record of played games, so matches can be replayed, audited and mined later.
+*           A Game_Record collects one game in fixed size arrays while it is played, and a Game_Writer
+*           appends finished games to a file through one buffer that any number of match threads can share.
+*           A Game_Reader maps the file and walks the games in place, without copying them.
+*
+*           File layout (little endian): an 8 byte magic "BOOPGAME", a uint32 version, a uint32 of 0, then
+*           one entry per game:
+*               uint32 size         Bytes in the rest of the entry, so a reader can skip it
+*               uint8 winner        Boop::who, NEUTRAL for a tie
+*               uint8 flags         HAS_SCORES
+*               uint16 move_count
+*               float think_time    The think time per move, in ms
+*               uint64 seed
+*               uint8 length + chars, twice: the names of the P1 and P2 AIs
+*               uint16 moves[move_count]            Move::raw()
+*               uint16 think[move_count]            Time taken by each move, in tenths of a ms
+*               int16 scores[move_count]            Only with HAS_SCORES, the mover's search score or NO_SCORE
+*
+*/
+
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include "move.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+// One game while it is being played, appending a move never allocates
+class Game_Record {
+    public:
+        static const int MAX_MOVES = 600;                   // Boop::play stops a game after 300 turns of both players
+        static const int16_t NO_SCORE = INT16_MIN;          // The AI did not report a score for the move
+        static const int MAX_NAME = 255;
+
+        std::string P1_name;
+        std::string P2_name;
+        float think_time = 0;
+        uint64_t seed = 0;
+        uint8_t winner = 0;
+
+        /**
+         * @brief Starts a new game, keeping the names
+         * @param with_scores Whether the game keeps a score for each move
+        */
+        void clear(bool with_scores) {
+            move_count = 0;
+            scores_kept = with_scores;
+        }
+
+        /**
+         * @brief Adds the next move of the game, moves past MAX_MOVES are dropped
+         * @param think_ms How long the move took
+         * @param score The mover's search score, or NO_SCORE
+        */
+        void add_move(Move move, double think_ms, int score = NO_SCORE) {
+            if(move_count >= MAX_MOVES) { return; }
+            moves[move_count] = move.raw();
+            think[move_count] = (uint16_t) std::min(std::max(think_ms * 10 + 0.5, 0.0), 65535.0);
+            scores[move_count] = score == NO_SCORE ? NO_SCORE : (int16_t) std::min(std::max(score, -32767), 32767);
+            move_count++;
+        }
+
+        int size() const { return move_count; }
+        bool with_scores() const { return scores_kept; }
+        Move move(int i) const { return Move::from_raw(moves[i]); }
+        int score(int i) const { return scores_kept ? scores[i] : NO_SCORE; }
+
+    private:
+        friend class Game_Writer;
+
+        int move_count = 0;
+        bool scores_kept = false;
+        uint16_t moves[MAX_MOVES];
+        uint16_t think[MAX_MOVES];
+        int16_t scores[MAX_MOVES];
+};
+
+// Where Boop::play hands each game it finishes
+class Game_Recorder {
+    public:
+        virtual ~Game_Recorder() { }
+
+        /**
+         * @brief Takes a finished game, called from whichever thread played it
+        */
+        virtual void write(const Game_Record& game) = 0;
+};
+
+// Appends games to a file, one buffered write per game under a lock
+class Game_Writer : public Game_Recorder {
+    public:
+        Game_Writer() { }
+        ~Game_Writer() { close(); }
+
+        Game_Writer(const Game_Writer&) = delete;
+        Game_Writer& operator = (const Game_Writer&) = delete;
+
+        /**
+         * @brief Creates (or empties) a game file and writes its header
+         * @return A bool indicating if the file could be created
+        */
+        bool open(const std::string& path);
+
+        /**
+         * @brief Flushes the buffer and closes the file
+         * @return A bool indicating if every game since open() made it into the file
+        */
+        bool close();
+
+        /**
+         * @brief Appends a finished game, safe to call from several threads at once. After a write fails
+         *        later games are dropped, see has_failed()
+        */
+        void write(const Game_Record& game) override;
+
+        // True once a write has failed, the file ends with the last game written in full before it
+        bool has_failed() const { return failed; }
+
+        /**
+         * @brief The number of games written since the file was opened
+        */
+        long long games() const { return games_written; }
+
+    private:
+        static const size_t BUFFER_SIZE = 1 << 20;
+
+        FILE* file = nullptr;
+        std::mutex lock;
+        long long games_written = 0;
+        std::atomic<bool> failed{false};
+};
+
+// Reads a game file through a read only mapping, one game at a time
+class Game_Reader {
+    public:
+        // One game, pointing into the mapping, valid while the reader is open
+        class Game {
+            public:
+                uint8_t winner = 0;
+                float think_time = 0;
+                uint64_t seed = 0;
+                std::string P1_name() const { return std::string(P1, P1_length); }
+                std::string P2_name() const { return std::string(P2, P2_length); }
+
+                int size() const { return move_count; }
+                bool with_scores() const { return scores != nullptr; }
+                Move move(int i) const { return Move::from_raw(read16(moves, i)); }
+                double think_ms(int i) const { return read16(think, i) / 10.0; }
+                int score(int i) const { return scores == nullptr ? Game_Record::NO_SCORE : (int16_t) read16(scores, i); }
+
+            private:
+                friend class Game_Reader;
+
+                const char* P1 = nullptr;
+                const char* P2 = nullptr;
+                int P1_length = 0;
+                int P2_length = 0;
+                int move_count = 0;
+                const char* moves = nullptr;
+                const char* think = nullptr;
+                const char* scores = nullptr;
+
+                // The columns are not aligned in the file
+                static uint16_t read16(const char* column, int i) {
+                    uint16_t value;
+                    memcpy(&value, column + 2 * i, sizeof(value));
+                    return value;
+                }
+        };
+
+        Game_Reader() { }
+        ~Game_Reader() { close(); }
+
+        Game_Reader(const Game_Reader&) = delete;
+        Game_Reader& operator = (const Game_Reader&) = delete;
+
+        /**
+         * @brief Maps a game file and starts at its first game
+         * @return A bool indicating if the file exists and is a game file
+        */
+        bool open(const std::string& path);
+        void close();
+
+        /**
+         * @brief Moves on to the next game
+         * @param game Filled in with the game
+         *
+         * @return A bool indicating if there was another whole game
+        */
+        bool next(Game& game);
+
+    private:
+        void* mapping = nullptr;
+        size_t mapping_size = 0;
+        size_t offset = 0;
+};
+
+#endif
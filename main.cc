@@ -1,5 +1,12 @@
 #include <iomanip>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "boop.h"
+#include "game_record.h"
+#include "opening_book.h"
 #include "Timer.h"
 #include "AI/RandomAI.h"
 #include "AI/Winning_AI.h"
@@ -7,47 +14,179 @@
 #include "AI/Boopy_AI.h"
 #include "AI/Boopy_Alpha_Beta.h"     // BEST AI YET
 #include "AI/Minimax_Alpha_Beta_AI.h"
-#include "AI/Human_AI.h"  // USE HUMAN AI TO PLAY AGAINST ANOTHER AI
+#include "AI/NNUE_AI.h"
+#include "AI/MCTS_AI.h"
+#include "AI/Human_AI.h"  // USE HUMAN AI TO PLAY AGAINST ANOTHER AI, WITH num_threads = 1
 
-int main() {
+// Builds a new AI, each worker thread needs its own since an AI is bound to one game
+using AI_Factory = std::function<AI*()>;
+
+struct Match_Summary {
     int P1_Wins = 0;
     int P2_Wins = 0;
     int Ties = 0;
+    int games_played = 0;
+    double average_duration = 0;
+    Boop::Search_Totals P1_search;
+    Boop::Search_Totals P2_search;
+    Boop::Overrun_Totals P1_overruns;
+    Boop::Overrun_Totals P2_overruns;
+};
 
-    Boop::Game_Results results;
+// Records one game and prints its progress line, called by the workers with the lock held
+void report_game(Match_Summary& summary, const Boop::Game_Results& results, int num_games, int num_threads) {
+    int i = ++summary.games_played;
+    if(results.winner == Boop::P1) { 
+        summary.P1_Wins++; 
+    } else if(results.winner == Boop::P2) { 
+        summary.P2_Wins++; 
+    } else { 
+        summary.Ties++; 
+    }
 
-    AI* AI1 = new Random_AI;
-    AI* AI2 = new Minimax_Alpha_Beta_AI;
-    double think_time = 100; // ms
-    Boop mygame(AI1, AI2, think_time);
+    summary.average_duration = (summary.average_duration + results.duration)/2;
+    summary.P1_search.add(results.P1_search);
+    summary.P2_search.add(results.P2_search);
+    summary.P1_overruns.add(results.P1_overruns);
+    summary.P2_overruns.add(results.P2_overruns);
 
-    int num_games = 100;
-    double average_duration = 0;
+    cout << std::fixed << std::setprecision(1) << (double) i*100/num_games << "% |";
+    cout << std::fixed << std::setprecision(2) << " ETA: "<< (double) (summary.average_duration * (num_games - i))/num_threads/1000 << " sec |";
+    cout << " W: " << (results.winner == Boop::P1 ? "P1 " : (results.winner == Boop::P2 ? "P2 " : "Tie"));
+    cout << " | T: " << results.num_moves;
+    cout << std::fixed << std::setprecision(2) << " | Avg Think (ms) [P1: " << results.P1_avg_think_time << "] [P2: " << results.P2_avg_think_time << "]\n";
+}
+
+// Prints the search statistics of a player, if their AI reports any
+void report_search(const string& player, const Boop::Search_Totals& search) {
+    if(search.thinks == 0) { return; }
+    cout << player << " search | Nodes/think: " << search.nodes / search.thinks;
+    cout << " | Leaf evals/think: " << search.leaf_evaluations / search.thinks;
+    cout << std::fixed << std::setprecision(2) << " | Depth: " << search.average_depth() << " avg, " << search.max_depth << " max";
+    cout << " | EBF: " << search.average_branching();
+    cout << std::setprecision(1) << " | First move cutoffs: " << search.first_move_cutoff_rate() * 100 << "%";
+    cout << " | Timed out: " << (double) search.time_outs * 100 / search.thinks << "%";
+    cout << " | Book moves: " << search.book_moves << "\n";
+}
+
+// Prints how often a player missed their deadline, if they ever did
+void report_overruns(const string& player, const Boop::Overrun_Totals& overruns) {
+    if(overruns.late == 0 && overruns.overruns == 0 && overruns.illegal_moves == 0) { return; }
+    cout << player << " deadlines | Late: " << overruns.late << " | Overruns: " << overruns.overruns;
+    cout << " (" << overruns.published_moves << " published, " << overruns.default_moves << " default moves)";
+    cout << " | Illegal: " << overruns.illegal_moves;
+    cout << std::fixed << std::setprecision(2) << " | Worst: " << overruns.worst_ms << " ms past the deadline";
+    cout << (overruns.forfeited ? " | Forfeited a game" : "") << "\n";
+}
+
+/**
+ * @brief Plays a match, spreading the games over several threads
+ * @param make_P1 Builds the AI for player 1
+ * @param make_P2 Builds the AI for player 2
+ * @param think_time How long each AI gets per move in ms
+ * @param num_games The number of games to play
+ * @param num_threads The number of games played at once, each with its own Boop and AIs
+ * @param deadlines How each game keeps the AIs to their think time
+ * @param recorder Where to record the games, or nullptr to not record them
+*/
+Match_Summary play_match(const AI_Factory& make_P1, const AI_Factory& make_P2, double think_time, int num_games, int num_threads,
+                         const Boop::Deadline_Policy& deadlines, Game_Writer* recorder) {
+    Match_Summary summary;
+    std::mutex summary_lock;
+    int next_game = 0;
+
+    auto worker = [&]() {
+        std::unique_ptr<AI> AI1(make_P1());
+        std::unique_ptr<AI> AI2(make_P2());
+        Boop mygame(AI1.get(), AI2.get(), think_time);
+        mygame.set_deadline_policy(deadlines);
+        mygame.set_recorder(recorder, true);
+
+        while(true) {
+            {
+                std::lock_guard<std::mutex> guard(summary_lock);
+                if(next_game >= num_games) { return; }
+                mygame.set_seed(next_game++);
+            }
 
-    for(int i = 1; i <= num_games; ++i) {
-        results = mygame.play();
+            Boop::Game_Results results = mygame.play();
 
-        if(results.winner == Boop::P1) { 
-            P1_Wins++; 
-        } else if(results.winner == Boop::P2) { 
-            P2_Wins++; 
-        } else { 
-            Ties++; 
+            std::lock_guard<std::mutex> guard(summary_lock);
+            report_game(summary, results, num_games, num_threads);
         }
+    };
 
-        average_duration = (average_duration + results.duration)/2;
+    std::vector<std::thread> workers;
+    for(int i = 1; i < num_threads; ++i) { workers.emplace_back(worker); }
+    worker(); // The main thread plays too
+    for(std::thread& thread : workers) { thread.join(); }
 
-        cout << std::fixed << std::setprecision(1) << (double) i*100/num_games << "% |";
-        cout << std::fixed << std::setprecision(2) << " ETA: "<< (double) (average_duration * (num_games - i))/1000 << " sec |";
-        cout << " W: " << (results.winner == Boop::P1 ? "P1 " : (results.winner == Boop::P2 ? "P2 " : "Tie"));
-        cout << " | T: " << results.num_moves;
-        cout << std::fixed << std::setprecision(2) << " | Avg Think (ms) [P1: " << results.P1_avg_think_time << "] [P2: " << results.P2_avg_think_time << "]\n";
+    return summary;
+}
+
+int main(int argc, char* argv[]) {
+    // Built by "make book", the alpha beta AIs search every move without one
+    Opening_Book book;
+    if(book.open("book.bin")) { cout << "Opening book: " << book.size() << " positions\n"; }
+
+    // Written by "make tune", the alpha beta AI keeps its own weights without them
+    Eval_Weights weights = Eval_Weights::alpha_beta();
+    if(weights.load("weights.txt")) { cout << "Evaluation weights: weights.txt\n"; }
+
+    // Set to play NNUE_AI as P2, with the network "make train_nnue" writes to nnue.bin
+    const bool use_network = false;
+    NNUE_Network network;
+    if(use_network && !network.load("nnue.bin")) {
+        cout << "Could not read a network from nnue.bin, run \"make train_nnue\" first\n";
+        return 1;
     }
 
+    AI_Factory make_AI1 = [] { return new Random_AI; };
+    AI_Factory make_AI2 = [&book, &weights, &network, use_network]() -> AI* {
+        if(use_network) {
+            NNUE_AI* AI = new NNUE_AI(&network);
+            AI->set_book(&book);
+            return AI;
+        }
+        Minimax_Alpha_Beta_AI* AI = new Minimax_Alpha_Beta_AI;
+        AI->set_book(&book);
+        AI->set_weights(weights);
+        return AI;
+    };
+    double think_time = 100; // ms
+
+    int num_games = 100;
+    // Games played at once, pass a thread count to override (e.g., "./a.out 8")
+    int num_threads = argc > 1 ? atoi(argv[1]) : (int) std::thread::hardware_concurrency();
+    num_threads = std::max(1, std::min(num_threads, num_games));
+
+    // Unattended, so a think that runs long is cut off instead of stalling the match (turn off to play as a Human_AI)
+    Boop::Deadline_Policy deadlines;
+    deadlines.enforce = true;
+    deadlines.grace_ms = 10;
+
+    // Every game is kept in games.bin, "make games" builds a tool to read it
+    Game_Writer recorder;
+    if(!recorder.open("games.bin")) { cout << "Could not open games.bin, the games will not be recorded\n"; }
+
+    Match_Summary summary = play_match(make_AI1, make_AI2, think_time, num_games, num_threads, deadlines, &recorder);
+    bool recorded = recorder.close();
+    int P1_Wins = summary.P1_Wins;
+    int P2_Wins = summary.P2_Wins;
+
     cout << "Player 1 Won: " << P1_Wins << " games\n";
     cout << "Player 2 Won: " << P2_Wins << " games\n";
-    cout << "        Ties: " << Ties << " games\n"; 
+    cout << "        Ties: " << summary.Ties << " games\n"; 
     cout << (P1_Wins > P2_Wins ? "Player 1" : "Player 2") << " is ~" << (P1_Wins > P2_Wins ? ((double) (P1_Wins-P2_Wins)/P2_Wins)*100 : ((double) (P2_Wins-P1_Wins)/P1_Wins)*100) << "% better\n";
+    report_search("Player 1", summary.P1_search);
+    report_search("Player 2", summary.P2_search);
+    report_overruns("Player 1", summary.P1_overruns);
+    report_overruns("Player 2", summary.P2_overruns);
+    if(recorder.games() > 0) { cout << "Recorded " << recorder.games() << " games to games.bin\n"; }
+    if(!recorded) {
+        cout << "Could not write every game to games.bin, " << summary.games_played - recorder.games() << " games were lost\n";
+        return 1;
+    }
 
    return 0;
 
@@ -0,0 +1,197 @@
+/**
+*    @file: move.h
+*   @brief: A packed 16 bit move and a fixed capacity move list, so search can run without heap
+*           allocations or string parsing. The string form ("ba1", "a1 a2 a3", "a1") is only
+*           used to talk to humans and for logging.
+*
+*/
+
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <string>
+
+class Move {
+    public:
+        static const int SIZE = 6;
+        enum Kind { NO_MOVE, PLACE, REMOVE_THREE, REMOVE_ONE };
+        enum Line { EAST, SOUTH_EAST, SOUTH, SOUTH_WEST }; // Direction a REMOVE_THREE line walks from its first square
+
+        Move() { }
+
+        /**
+         * @brief Places a bunny or rabbit on a square
+         * @param square The square index (y * SIZE + x)
+         * @param cat True to place a rabbit, false to place a bunny
+        */
+        static Move place(int square, bool cat) { return Move(PLACE << KIND_SHIFT | (cat ? CAT_BIT : 0) | square); }
+
+        /**
+         * @brief Removes three pieces in a row, starting at a square and walking along a line
+         * @param square The square index (y * SIZE + x) of the first piece
+         * @param line The direction the other two pieces are in
+        */
+        static Move remove_three(int square, Line line) { return Move(REMOVE_THREE << KIND_SHIFT | line << LINE_SHIFT | square); }
+
+        /**
+         * @brief Removes a single piece from the board
+         * @param square The square index (y * SIZE + x) of the piece
+        */
+        static Move remove_one(int square) { return Move(REMOVE_ONE << KIND_SHIFT | square); }
+
+        Kind kind() const { return (Kind) (bits >> KIND_SHIFT & 3); }
+        bool cat() const { return bits & CAT_BIT; }
+        Line line() const { return (Line) (bits >> LINE_SHIFT & 3); }
+        int square() const { return bits & SQUARE_MASK; }
+        int x() const { return square() % SIZE; }
+        int y() const { return square() / SIZE; }
+
+        /**
+         * @brief The square of the i-th piece removed by a REMOVE_THREE move
+         * @param i 0, 1 or 2
+        */
+        int square(int i) const {
+            return (y() + LINE_DY[line()] * i) * SIZE + x() + LINE_DX[line()] * i;
+        }
+
+        /**
+         * @brief A dense index for tables keyed on moves, below INDEX_COUNT
+         * @note Bunny and rabbit placements, each REMOVE_THREE line and REMOVE_ONE moves each get their own block of squares
+        */
+        int index() const {
+            int block = kind() == PLACE ? cat() : (kind() == REMOVE_THREE ? 2 + line() : 6);
+            return block * SIZE * SIZE + square();
+        }
+        static const int INDEX_COUNT = 7 * SIZE * SIZE;
+
+        uint16_t raw() const { return bits; }
+        static Move from_raw(uint16_t raw) { return Move(raw); }
+
+        bool operator == (Move other) const { return bits == other.bits; }
+        bool operator != (Move other) const { return bits != other.bits; }
+
+        /**
+         * @brief The human readable form of the move (e.g., "bc4", "a1 a2 a3" or "c3")
+        */
+        std::string to_string() const {
+            switch(kind()) {
+                case PLACE:
+                    return (cat() ? "r" : "b") + square_name(square());
+                case REMOVE_THREE:
+                    return square_name(square(0)) + ' ' + square_name(square(1)) + ' ' + square_name(square(2));
+                case REMOVE_ONE:
+                    return square_name(square());
+                default:
+                    return "";
+            }
+        }
+
+        /**
+         * @brief Parses the human readable form of a move, letters may be upper or lower case
+         * @param move The move string (e.g., "bc4", "a1 a2 a3" or "c3")
+         *
+         * @return The parsed move, or a NO_MOVE move if the string does not describe a move on the board
+        */
+        static Move from_string(const std::string& move) {
+            if(move.length() == 3) { // "ba1"
+                char type = (move[0] >= 'A' && move[0] <= 'Z') ? move[0] + 32 : move[0]; // To lowercase
+                int sq = parse_square(move[1], move[2]);
+                if(sq < 0 || (type != 'b' && type != 'r')) { return Move(); }
+                return place(sq, type == 'r');
+            }
+            if(move.length() == 2) { // "a1"
+                int sq = parse_square(move[0], move[1]);
+                return sq < 0 ? Move() : remove_one(sq);
+            }
+            if(move.length() == 8) { // "a1 a2 a3", in any order
+                int squares[3];
+                for(int i = 0; i < 3; ++i) {
+                    squares[i] = parse_square(move[i*3], move[i*3+1]);
+                    if(squares[i] < 0) { return Move(); }
+                }
+                // Find the end of the line the other two squares walk away from
+                for(int first = 0; first < 3; ++first) {
+                    for(int line = EAST; line <= SOUTH_WEST; ++line) {
+                        Move candidate = remove_three(squares[first], (Line) line);
+                        if(!candidate.on_board()) { continue; }
+                        int second = candidate.square(1);
+                        int third = candidate.square(2);
+                        int a = squares[(first + 1) % 3];
+                        int b = squares[(first + 2) % 3];
+                        if((a == second && b == third) || (a == third && b == second)) { return candidate; }
+                    }
+                }
+            }
+            return Move();
+        }
+
+        /**
+         * @brief Checks that every square the move touches is on the board
+        */
+        bool on_board() const {
+            if(kind() == NO_MOVE) { return false; }
+            if(kind() != REMOVE_THREE) { return true; }
+            int end_x = x() + LINE_DX[line()] * 2;
+            int end_y = y() + LINE_DY[line()] * 2;
+            return end_x >= 0 && end_x < SIZE && end_y >= 0 && end_y < SIZE;
+        }
+
+        /**
+         * @brief Returns the name of a square index (e.g., "c4")
+        */
+        static std::string square_name(int square) {
+            std::string out;
+            out.push_back((char) (square / SIZE) + 'a');
+            out.push_back((char) (square % SIZE) + '1');
+            return out;
+        }
+
+    private:
+        static const int SQUARE_MASK = 0x3F;
+        static const int CAT_BIT = 1 << 6;
+        static const int LINE_SHIFT = 7;
+        static const int KIND_SHIFT = 12;
+        static constexpr int LINE_DX[4] = { 1,  1,  0, -1 }; // E, SE, S, SW
+        static constexpr int LINE_DY[4] = { 0, -1, -1, -1 };
+
+        uint16_t bits = 0;
+
+        explicit Move(int raw) : bits((uint16_t) raw) { }
+
+        // Returns the square index of a column letter and row number, or -1 if it is off the board
+        static int parse_square(char letter, char number) {
+            int y = (letter >= 'A' && letter <= 'Z') ? letter - 'A' : letter - 'a';
+            int x = (int) number - '1';
+            if(x < 0 || x >= SIZE || y < 0 || y >= SIZE) { return -1; }
+            return y * SIZE + x;
+        }
+};
+
+/**
+ * A list of moves that lives on the stack. The capacity covers the worst case of every move type,
+ * 72 placements or every three in a row line on the board.
+*/
+class MoveList {
+    public:
+        static const int CAPACITY = 80;
+
+        void push(Move move) { moves[count++] = move; }
+        void clear() { count = 0; }
+        int size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        Move& operator [] (int i) { return moves[i]; }
+        Move operator [] (int i) const { return moves[i]; }
+
+        Move* begin() { return moves; }
+        Move* end() { return moves + count; }
+        const Move* begin() const { return moves; }
+        const Move* end() const { return moves + count; }
+
+    private:
+        Move moves[CAPACITY];
+        int count = 0;
+};
+
+#endif
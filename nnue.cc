@@ -0,0 +1,224 @@
+/**
+*    @file: nnue.cc
+*   @brief: Accumulator updates and the integer layers of the network evaluation
+*
+*/
+
+#include "nnue.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86
+#endif
+
+static const char NNUE_MAGIC[8] = { 'B', 'O', 'O', 'P', 'N', 'N', 'U', 'E' };
+static const uint32_t NNUE_VERSION = 1;
+
+using Layer_1_Weights = int8_t[NNUE_Network::LAYER_1][2 * NNUE_Network::HIDDEN];
+
+/// LAYER 1 KERNELS
+// Every one computes out[i] = bias[i] + the dot product of the clipped accumulators and row i
+static void layer_1_scalar(const uint8_t* input, const Layer_1_Weights& weights, const int32_t* bias, int32_t* out) {
+    for(int i = 0; i < NNUE_Network::LAYER_1; ++i) {
+        int32_t sum = bias[i];
+        for(int j = 0; j < 2 * NNUE_Network::HIDDEN; ++j) { sum += input[j] * weights[i][j]; }
+        out[i] = sum;
+    }
+}
+
+#ifdef NNUE_X86
+// maddubs multiplies unsigned inputs by signed weights and adds neighbouring pairs, 2 * 127 * 127 fits in 16 bits
+__attribute__((target("avx2")))
+static void layer_1_avx2(const uint8_t* input, const Layer_1_Weights& weights, const int32_t* bias, int32_t* out) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i in[4];
+    for(int k = 0; k < 4; ++k) { in[k] = _mm256_load_si256((const __m256i*) (input + 32 * k)); }
+    for(int i = 0; i < NNUE_Network::LAYER_1; ++i) {
+        __m256i sum = _mm256_setzero_si256();
+        for(int k = 0; k < 4; ++k) {
+            __m256i products = _mm256_maddubs_epi16(in[k], _mm256_load_si256((const __m256i*) (weights[i] + 32 * k)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+        }
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+        out[i] = bias[i] + _mm_cvtsi128_si32(half);
+    }
+}
+
+__attribute__((target("ssse3")))
+static void layer_1_ssse3(const uint8_t* input, const Layer_1_Weights& weights, const int32_t* bias, int32_t* out) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i in[8];
+    for(int k = 0; k < 8; ++k) { in[k] = _mm_load_si128((const __m128i*) (input + 16 * k)); }
+    for(int i = 0; i < NNUE_Network::LAYER_1; ++i) {
+        __m128i sum = _mm_setzero_si128();
+        for(int k = 0; k < 8; ++k) {
+            __m128i products = _mm_maddubs_epi16(in[k], _mm_load_si128((const __m128i*) (weights[i] + 16 * k)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        out[i] = bias[i] + _mm_cvtsi128_si32(sum);
+    }
+}
+#endif
+
+using Layer_1_Kernel = void (*)(const uint8_t*, const Layer_1_Weights&, const int32_t*, int32_t*);
+
+// The widest kernel this CPU runs, picked once
+static Layer_1_Kernel pick_layer_1() {
+#ifdef NNUE_X86
+    __builtin_cpu_init(); // This runs before main, possibly before the CPU checks are set up on their own
+    if(__builtin_cpu_supports("avx2")) { return layer_1_avx2; }
+    if(__builtin_cpu_supports("ssse3")) { return layer_1_ssse3; }
+#endif
+    return layer_1_scalar;
+}
+
+static const Layer_1_Kernel layer_1 = pick_layer_1();
+
+/// INPUTS
+int NNUE_Network::piece_input(int view, Boop_Types::PieceType type, int square) {
+    bool mine = (type == Boop_Types::P1_KIT || type == Boop_Types::P1_CAT) == (view == 0);
+    bool cat = type == Boop_Types::P1_CAT || type == Boop_Types::P2_CAT;
+    return ((mine ? 0 : 2) + (cat ? 1 : 0)) * SQUARES + square;
+}
+
+int NNUE_Network::reserve_input(int view, Boop_Types::PieceType type, int count) {
+    bool mine = (type == Boop_Types::P1_KIT || type == Boop_Types::P1_CAT) == (view == 0);
+    bool cat = type == Boop_Types::P1_CAT || type == Boop_Types::P2_CAT;
+    return PIECE_INPUTS + ((mine ? 0 : 2) + (cat ? 1 : 0)) * (MAX_RESERVE + 1) + std::min(std::max(count, 0), MAX_RESERVE);
+}
+
+// The reserve of one piece type, indexed the same as the bitboards
+static int reserve_of(const Position& position, Boop_Types::PieceType type) {
+    switch(type) {
+        case Boop_Types::P1_KIT: return position.kittens(Boop_Types::P1);
+        case Boop_Types::P1_CAT: return position.cats(Boop_Types::P1);
+        case Boop_Types::P2_KIT: return position.kittens(Boop_Types::P2);
+        default:                 return position.cats(Boop_Types::P2);
+    }
+}
+
+static inline void add_row(int16_t* values, const int16_t* row) {
+    for(int i = 0; i < NNUE_Network::HIDDEN; ++i) { values[i] += row[i]; }
+}
+
+static inline void sub_row(int16_t* values, const int16_t* row) {
+    for(int i = 0; i < NNUE_Network::HIDDEN; ++i) { values[i] -= row[i]; }
+}
+
+void NNUE_Network::refresh(const Position& position, NNUE_Accumulator& accumulator) const {
+    for(int view = 0; view < 2; ++view) {
+        int16_t* values = accumulator.values[view];
+        memcpy(values, input_bias, sizeof(input_bias));
+        for(int t = 1; t <= 4; ++t) {
+            Boop_Types::PieceType type = (Boop_Types::PieceType) t;
+            for(uint64_t bits = position.pieces_of(type); bits != 0; bits &= bits - 1) {
+                add_row(values, input_weights[piece_input(view, type, __builtin_ctzll(bits))]);
+            }
+            add_row(values, input_weights[reserve_input(view, type, reserve_of(position, type))]);
+        }
+    }
+}
+
+void NNUE_Network::update(const NNUE_Accumulator& before, NNUE_Accumulator& after, const Position& position, const Position::Undo& undo) const {
+    after = before;
+    for(int t = 1; t <= 4; ++t) {
+        Boop_Types::PieceType type = (Boop_Types::PieceType) t;
+        uint64_t now = position.pieces_of(type);
+        uint64_t added = undo.changed[t - 1] & now;
+        uint64_t removed = undo.changed[t - 1] & ~now;
+        int reserve = reserve_of(position, type);
+        int reserve_before = reserve - undo.reserve_change[t - 1];
+
+        for(int view = 0; view < 2; ++view) {
+            int16_t* values = after.values[view];
+            for(uint64_t bits = added; bits != 0; bits &= bits - 1) { add_row(values, input_weights[piece_input(view, type, __builtin_ctzll(bits))]); }
+            for(uint64_t bits = removed; bits != 0; bits &= bits - 1) { sub_row(values, input_weights[piece_input(view, type, __builtin_ctzll(bits))]); }
+            if(reserve != reserve_before) {
+                sub_row(values, input_weights[reserve_input(view, type, reserve_before)]);
+                add_row(values, input_weights[reserve_input(view, type, reserve)]);
+            }
+        }
+    }
+}
+
+/// LAYERS
+int NNUE_Network::evaluate(const NNUE_Accumulator& accumulator, Boop_Types::who next_mover) const {
+    // Clip both views to 0..1, the player to move's first
+    alignas(32) uint8_t input[2 * HIDDEN];
+    int mine = next_mover == Boop_Types::P1 ? 0 : 1;
+    for(int half = 0; half < 2; ++half) {
+        const int16_t* values = accumulator.values[half == 0 ? mine : 1 - mine];
+        for(int i = 0; i < HIDDEN; ++i) { input[half * HIDDEN + i] = (uint8_t) std::min(std::max((int) values[i], 0), ACTIVATION_SCALE); }
+    }
+
+    int32_t hidden[LAYER_1];
+    layer_1(input, layer_1_weights, layer_1_bias, hidden);
+
+    int32_t output = output_bias;
+    for(int i = 0; i < LAYER_1; ++i) {
+        int32_t activation = std::min(std::max(hidden[i] / WEIGHT_SCALE, 0), ACTIVATION_SCALE);
+        output += activation * output_weights[i];
+    }
+    return (int) ((int64_t) output * OUTPUT_SCALE / (ACTIVATION_SCALE * WEIGHT_SCALE));
+}
+
+/// FILES
+struct NNUE_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t inputs;
+    uint32_t hidden;
+    uint32_t layer_1;
+};
+
+bool NNUE_Network::load(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if(file == nullptr) { return false; }
+
+    NNUE_Header header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC)) == 0
+              && header.version == NNUE_VERSION && header.inputs == INPUTS && header.hidden == HIDDEN && header.layer_1 == LAYER_1;
+
+    // Read into a copy, so a bad file changes nothing
+    NNUE_Network* read = new NNUE_Network;
+    valid = valid && fread(read->input_weights, sizeof(input_weights), 1, file) == 1
+                  && fread(read->input_bias, sizeof(input_bias), 1, file) == 1
+                  && fread(read->layer_1_weights, sizeof(layer_1_weights), 1, file) == 1
+                  && fread(read->layer_1_bias, sizeof(layer_1_bias), 1, file) == 1
+                  && fread(read->output_weights, sizeof(output_weights), 1, file) == 1
+                  && fread(&read->output_bias, sizeof(output_bias), 1, file) == 1;
+    fclose(file);
+    if(valid) {
+        *this = *read;
+        is_loaded = true;
+    }
+    delete read;
+    return valid;
+}
+
+bool NNUE_Network::save(const std::string& path) const {
+    NNUE_Header header;
+    memcpy(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC));
+    header.version = NNUE_VERSION;
+    header.inputs = INPUTS;
+    header.hidden = HIDDEN;
+    header.layer_1 = LAYER_1;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if(file == nullptr) { return false; }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                && fwrite(input_weights, sizeof(input_weights), 1, file) == 1
+                && fwrite(input_bias, sizeof(input_bias), 1, file) == 1
+                && fwrite(layer_1_weights, sizeof(layer_1_weights), 1, file) == 1
+                && fwrite(layer_1_bias, sizeof(layer_1_bias), 1, file) == 1
+                && fwrite(output_weights, sizeof(output_weights), 1, file) == 1
+                && fwrite(&output_bias, sizeof(output_bias), 1, file) == 1;
+    return fclose(file) == 0 && written;
+}
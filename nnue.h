@@ -0,0 +1,92 @@
+/**
+*    @file: nnue.h
+*   @brief: A small efficiently updatable neural network evaluation. The first layer sees one input per
+*           piece type on each square and one per reserve count, from both players' points of view, and
+*           its output (the accumulator) is only added to or taken from as pieces move, so a search keeps
+*           it up to date for a few additions per move instead of recomputing it. The layers after it are
+*           small and run on 8 bit integers, with AVX2 and SSSE3 kernels picked when the program starts
+*           and a plain C++ fallback.
+*
+*           The weights come from a file written by tools/train_nnue.cc.
+*
+*/
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "position.h"
+#include <cstdint>
+#include <string>
+
+// The first layer output for both points of view, values[0] as P1 sees the board and values[1] as P2 does
+struct NNUE_Accumulator {
+    static const int SIZE = 64;
+    alignas(32) int16_t values[2][SIZE];
+};
+
+class NNUE_Network {
+    public:
+        static const int SQUARES = Boop_Types::SIZE * Boop_Types::SIZE;
+        static const int MAX_RESERVE = 8;
+        static const int PIECE_INPUTS = 4 * SQUARES;                    // My kittens, my cats, their kittens, their cats
+        static const int INPUTS = PIECE_INPUTS + 4 * (MAX_RESERVE + 1); // Then the same four reserves, one input per count
+        static const int HIDDEN = NNUE_Accumulator::SIZE;
+        static const int LAYER_1 = 16;
+
+        // Fixed point scales, the trainer quantizes with the same ones
+        static const int ACTIVATION_SCALE = 127;                        // A clipped activation of 1.0
+        static const int WEIGHT_SCALE = 64;                             // A layer 1 or output weight of 1.0
+        static const int OUTPUT_SCALE = 200;                            // Evaluation units for a network output of 1.0
+
+        /**
+         * @brief Reads a weights file, the network is all zeros until one is loaded
+         * @return A bool indicating if the file exists and matches this network's shape
+        */
+        bool load(const std::string& path);
+
+        /**
+         * @brief Writes the weights to a file that load() reads
+        */
+        bool save(const std::string& path) const;
+
+        bool loaded() const { return is_loaded; }
+
+        // The input for a piece on a square, or a reserve count, from one player's point of view (0 for P1)
+        static int piece_input(int view, Boop_Types::PieceType type, int square);
+        static int reserve_input(int view, Boop_Types::PieceType type, int count);
+
+        /**
+         * @brief Computes the accumulator of a position from scratch
+        */
+        void refresh(const Position& position, NNUE_Accumulator& accumulator) const;
+
+        /**
+         * @brief Works out the accumulator after a move from the one before it
+         * @param before The accumulator of the position before the move
+         * @param after Filled in with the accumulator of the position after it
+         * @param position The position after the move
+         * @param undo What the move changed, as returned by Position::make_move
+        */
+        void update(const NNUE_Accumulator& before, NNUE_Accumulator& after, const Position& position, const Position::Undo& undo) const;
+
+        /**
+         * @brief Runs the layers after the accumulator
+         * @param next_mover The player to move, whose point of view goes first
+         *
+         * @return The evaluation for the player to move, positive when they are ahead
+        */
+        int evaluate(const NNUE_Accumulator& accumulator, Boop_Types::who next_mover) const;
+
+        /// The weights, public for the trainer
+        alignas(32) int16_t input_weights[INPUTS][HIDDEN] = {};
+        alignas(32) int16_t input_bias[HIDDEN] = {};
+        alignas(32) int8_t layer_1_weights[LAYER_1][2 * HIDDEN] = {};  // Inputs are my view then their view
+        int32_t layer_1_bias[LAYER_1] = {};
+        alignas(32) int8_t output_weights[LAYER_1] = {};
+        int32_t output_bias = 0;
+
+    private:
+        bool is_loaded = false;
+};
+
+#endif
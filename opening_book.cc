@@ -0,0 +1,106 @@
+/**
+*    @file: opening_book.cc
+*   @brief: Reading and writing opening book files
+*
+*/
+
+#include "opening_book.h"
+#include "symmetry.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char BOOK_MAGIC[8] = { 'B', 'O', 'O', 'P', 'B', 'O', 'O', 'K' };
+
+bool Opening_Book::open(const std::string& path) {
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0) { return false; }
+    struct stat status;
+    if(fstat(file, &status) != 0 || (size_t) status.st_size < sizeof(Header)) {
+        ::close(file);
+        return false;
+    }
+
+    // The mapping stays valid after the file is closed
+    void* map = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if(map == MAP_FAILED) { return false; }
+
+    const Header* header = (const Header*) map;
+    bool valid = memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) == 0 && header->version == VERSION
+              && header->entry_size == sizeof(Entry) && sizeof(Header) + header->count * sizeof(Entry) <= (size_t) status.st_size;
+    if(!valid) {
+        munmap(map, status.st_size);
+        return false;
+    }
+
+    mapping = map;
+    mapping_size = status.st_size;
+    entries = (const Entry*) ((const char*) map + sizeof(Header));
+    count = header->count;
+    return true;
+}
+
+void Opening_Book::close() {
+    if(mapping != nullptr) { munmap(mapping, mapping_size); }
+    mapping = nullptr;
+    mapping_size = 0;
+    entries = nullptr;
+    count = 0;
+}
+
+bool Opening_Book::probe(uint64_t key, Entry& entry) const {
+    const Entry* found = std::lower_bound(entries, entries + count, key, [](const Entry& e, uint64_t k) { return e.key < k; });
+    if(found == entries + count || found->key != key) { return false; }
+    entry = *found;
+    return true;
+}
+
+Move Opening_Book::pick(const Position& position, const MoveList& moves, uint64_t random) const {
+    Entry entry;
+    int turn;
+    if(!probe(position.canonical_key(&turn), entry)) { return Move(); }
+
+    // Only legal moves take part, in case the book was built by a different version of the engine
+    Move candidates[MOVES_PER_ENTRY];
+    uint32_t weights[MOVES_PER_ENTRY];
+    int candidate_count = 0;
+    uint32_t total = 0;
+    for(int i = 0; i < MOVES_PER_ENTRY; ++i) {
+        Move move = symmetry::move(symmetry::inverse(turn), Move::from_raw(entry.moves[i]));
+        if(entry.weights[i] == 0 || std::find(moves.begin(), moves.end(), move) == moves.end()) { continue; }
+        candidates[candidate_count] = move;
+        weights[candidate_count++] = entry.weights[i];
+        total += entry.weights[i];
+    }
+    if(candidate_count == 0) { return Move(); }
+
+    uint32_t roll = random % total;
+    for(int i = 0; i < candidate_count; ++i) {
+        if(roll < weights[i]) { return candidates[i]; }
+        roll -= weights[i];
+    }
+    return candidates[0];
+}
+
+bool Opening_Book::write(const std::string& path, std::vector<Entry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    Header header;
+    memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = VERSION;
+    header.entry_size = sizeof(Entry);
+    header.count = entries.size();
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if(file == nullptr) { return false; }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                && fwrite(entries.data(), sizeof(Entry), entries.size(), file) == entries.size();
+    return fclose(file) == 0 && written;
+}
@@ -0,0 +1,96 @@
+/**
+*    @file: opening_book.h
+*   @brief: Moves for the first few plies of the game, worked out ahead of time by tools/book.cc so the AIs
+*           don't have to search the same almost empty boards every game. The book is a file of entries
+*           sorted by Position::canonical_key(), memory mapped read only, so opening it is free and every
+*           AI and thread shares the same pages. A probe is a binary search over the mapping. Rotations and
+*           reflections of a position share its entry, which holds the moves for the canonical transform.
+*
+*/
+
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include "move.h"
+#include "position.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Opening_Book {
+    public:
+        static const int MOVES_PER_ENTRY = 4;
+
+        // One book position, with up to MOVES_PER_ENTRY good moves in it
+        struct Entry {
+            uint64_t key;                           // Position::canonical_key()
+            uint16_t moves[MOVES_PER_ENTRY];        // Move::raw() on the canonical board, best first, unused slots are 0
+            uint16_t weights[MOVES_PER_ENTRY];      // How often to play each move, relative to the others
+        };
+
+        Opening_Book() { }
+        ~Opening_Book() { close(); }
+
+        Opening_Book(const Opening_Book&) = delete;
+        Opening_Book& operator = (const Opening_Book&) = delete;
+
+        /**
+         * @brief Maps a book file, closing any book that was open
+         * @param path The file written by write()
+         *
+         * @return A bool indicating if the file exists and is a book
+        */
+        bool open(const std::string& path);
+        void close();
+
+        /**
+         * @brief The number of positions in the book, 0 when no book is open
+        */
+        size_t size() const { return count; }
+
+        /**
+         * @brief Looks up a position
+         * @param key The Position::canonical_key() of the position
+         * @param entry Filled in with the book entry, if there is one
+         *
+         * @return A bool indicating if the position is in the book
+        */
+        bool probe(uint64_t key, Entry& entry) const;
+
+        /**
+         * @brief Picks one of the book moves for a position, at random by weight
+         * @param position The position to move in
+         * @param moves The legal moves, a book move that is not one of them is never played
+         * @param random Any random number
+         *
+         * @return The move, turned to match the position, or an empty Move if the position is not in the book
+        */
+        Move pick(const Position& position, const MoveList& moves, uint64_t random) const;
+
+        /**
+         * @brief Writes a book file
+         * @param path Where to write it
+         * @param entries The positions, in any order, each key at most once
+         *
+         * @return A bool indicating if the file was written
+        */
+        static bool write(const std::string& path, std::vector<Entry> entries);
+
+    private:
+        static const uint32_t VERSION = 2;
+
+        struct Header {
+            char magic[8];                          // "BOOPBOOK"
+            uint32_t version;
+            uint32_t entry_size;
+            uint64_t count;
+        };
+
+        void* mapping = nullptr;
+        size_t mapping_size = 0;
+        const Entry* entries = nullptr;
+        size_t count = 0;
+};
+
+#endif
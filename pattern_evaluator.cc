@@ -0,0 +1,241 @@
+/**
+*    @file: pattern_evaluator.cc
+*   @brief: The window layout and lookup tables of the pattern evaluator, all built at compile time
+*
+*/
+
+#include "pattern_evaluator.h"
+
+static const int SIZE = Boop_Types::SIZE;
+static const int SQUARES = SIZE * SIZE;
+static const int STATES = 5;            // Empty, then each Boop_Types::PieceType
+static const int LINE_STATES = STATES * STATES * STATES;
+static const int CORNER_STATES = STATES * STATES * STATES * STATES;
+
+// The byte each count is packed into, the P2 count is the byte after the P1 one
+enum Line_Count { KITTEN_PAIRS = 0, KITTEN_THREES = 2, CAT_PAIRS = 4, CAT_THREES = 6 };
+enum Corner_Count { CAT_TRIS = 0, KITTEN_TRIS = 2, FRIENDLY_TRIS = 4 };
+
+/// LAYOUT
+// A window is up to four squares, -1 for a square that never counts. The base of its index picks the part of
+// the table that scores it: a line's last window in its direction also counts the pair in its last two
+// squares, and the friendly tris are scored apart from the single type tris.
+struct Window {
+    int squares[4];
+    int base;
+};
+
+struct Pattern_Layout {
+    Window lines[Pattern_Windows::LINES] = {};
+    Window corners[Pattern_Windows::CORNERS] = {};
+    int line_count = 0;
+    int corner_count = 0;
+};
+
+constexpr bool on_board(int x, int y) { return x >= 0 && x < SIZE && y >= 0 && y < SIZE; }
+constexpr int square_at(int x, int y) { return on_board(x, y) ? y * SIZE + x : -1; }
+
+constexpr Pattern_Layout make_layout() {
+    Pattern_Layout layout;
+
+    // Lines in the four directions count_rows walks, every pair of neighbours falls in exactly one window
+    const int directions[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+    int lines = 0;
+    for(const auto& d : directions) {
+        for(int y = 0; y < SIZE; ++y) {
+            for(int x = 0; x < SIZE; ++x) {
+                bool starts_pair = on_board(x + d[0], y + d[1]) && !on_board(x - d[0], y - d[1]);
+                bool fits = on_board(x + 2 * d[0], y + 2 * d[1]);
+                // Diagonals in the corners are only two squares long, a window with its third square missing
+                if(!fits && !starts_pair) { continue; }
+                Window& line = layout.lines[lines++];
+                line.squares[0] = square_at(x, y);
+                line.squares[1] = square_at(x + d[0], y + d[1]);
+                line.squares[2] = square_at(x + 2 * d[0], y + 2 * d[1]);
+                line.squares[3] = -1;
+                line.base = on_board(x + 3 * d[0], y + 3 * d[1]) ? 0 : LINE_STATES;
+            }
+        }
+    }
+
+    // The single type tris, with the squares bitboard::count_tri_pattern matches for the top two rows
+    int corners = 0;
+    for(int y = 0; y + 2 < SIZE; ++y) {
+        for(int x = 0; x + 2 < SIZE; ++x) {
+            Window& corner = layout.corners[corners++];
+            corner.squares[0] = square_at(x, y);
+            corner.squares[1] = square_at(x + 2, y);
+            corner.squares[2] = y >= 2 ? square_at(x, y - 2) : square_at(x - 1, y + 4);
+            corner.squares[3] = y >= 2 ? square_at(x + 2, y - 2) : square_at(x + 1, y + 4);
+            corner.base = 0;
+        }
+    }
+    // The player to move's tris, where corners on the outer edge of the board do not count
+    for(int y = 0; y + 2 < SIZE; ++y) {
+        for(int x = 0; x + 2 < SIZE; ++x) {
+            Window& corner = layout.corners[corners++];
+            corner.squares[0] = x != 0 && y != 0 ? square_at(x, y) : -1;
+            corner.squares[1] = x + 2 != SIZE - 1 && y != 0 ? square_at(x + 2, y) : -1;
+            corner.squares[2] = x != 0 && y + 2 != SIZE - 1 ? square_at(x, y + 2) : -1;
+            corner.squares[3] = x + 2 != SIZE - 1 && y + 2 != SIZE - 1 ? square_at(x + 2, y + 2) : -1;
+            corner.base = CORNER_STATES;
+        }
+    }
+
+    layout.line_count = lines;
+    layout.corner_count = corners;
+    return layout;
+}
+
+constexpr Pattern_Layout LAYOUT = make_layout();
+static_assert(LAYOUT.line_count == Pattern_Windows::LINES && LAYOUT.corner_count == Pattern_Windows::CORNERS, "Window counts");
+
+// What placing a piece adds to every window index, for each piece type and square. Taking it off takes the
+// same back out, and as whole arrays the compiler can add them a vector at a time.
+struct Square_Deltas {
+    uint8_t lines[Pattern_Windows::LINE_SLOTS] = {};
+    uint16_t corners[Pattern_Windows::CORNERS] = {};
+};
+
+struct Delta_Table {
+    Square_Deltas of[4][SQUARES] = {};
+};
+
+constexpr Delta_Table make_delta_table() {
+    Delta_Table table;
+    for(int t = 1; t <= 4; ++t) {
+        for(int w = 0; w < Pattern_Windows::LINES; ++w) {
+            for(int i = 0, digit = 1; i < 3; ++i, digit *= STATES) {
+                int square = LAYOUT.lines[w].squares[i];
+                if(square >= 0) { table.of[t - 1][square].lines[w] = t * digit; }
+            }
+        }
+        for(int w = 0; w < Pattern_Windows::CORNERS; ++w) {
+            for(int i = 0, digit = 1; i < 4; ++i, digit *= STATES) {
+                int square = LAYOUT.corners[w].squares[i];
+                if(square >= 0) { table.of[t - 1][square].corners[w] = t * digit; }
+            }
+        }
+    }
+    return table;
+}
+
+constexpr Delta_Table DELTAS = make_delta_table();
+
+/// TABLES
+constexpr int digit_of(int index, int i) {
+    for(; i > 0; --i) { index /= STATES; }
+    return index % STATES;
+}
+
+constexpr uint64_t count_at(int byte) { return 1ULL << (8 * byte); }
+
+struct Line_Table {
+    uint64_t counts[2 * LINE_STATES] = {};
+};
+
+constexpr Line_Table make_line_table() {
+    Line_Table table;
+    for(int last = 0; last < 2; ++last) {
+        for(int index = 0; index < LINE_STATES; ++index) {
+            uint64_t counts = 0;
+            for(int p = 0; p < 2; ++p) {
+                int kitten = p == 0 ? Boop_Types::P1_KIT : Boop_Types::P2_KIT;
+                int cat = p == 0 ? Boop_Types::P1_CAT : Boop_Types::P2_CAT;
+                int a = digit_of(index, 0), b = digit_of(index, 1), c = digit_of(index, 2);
+                if(a == kitten && b == kitten) { counts += count_at(KITTEN_PAIRS + p); }
+                if(last && b == kitten && c == kitten) { counts += count_at(KITTEN_PAIRS + p); }
+                if(a == kitten && b == kitten && c == kitten) { counts += count_at(KITTEN_THREES + p); }
+                if(a == cat && b == cat) { counts += count_at(CAT_PAIRS + p); }
+                if(last && b == cat && c == cat) { counts += count_at(CAT_PAIRS + p); }
+                if(a == cat && b == cat && c == cat) { counts += count_at(CAT_THREES + p); }
+            }
+            table.counts[last * LINE_STATES + index] = counts;
+        }
+    }
+    return table;
+}
+
+struct Corner_Table {
+    uint64_t counts[2 * CORNER_STATES] = {};
+};
+
+constexpr Corner_Table make_corner_table() {
+    Corner_Table table;
+    for(int friendly = 0; friendly < 2; ++friendly) {
+        for(int index = 0; index < CORNER_STATES; ++index) {
+            uint64_t counts = 0;
+            for(int p = 0; p < 2; ++p) {
+                int kitten = p == 0 ? Boop_Types::P1_KIT : Boop_Types::P2_KIT;
+                int cat = p == 0 ? Boop_Types::P1_CAT : Boop_Types::P2_CAT;
+                int kittens = 0, cats = 0;
+                for(int i = 0; i < 4; ++i) {
+                    kittens += digit_of(index, i) == kitten;
+                    cats += digit_of(index, i) == cat;
+                }
+                // At least three of the four corners
+                if(friendly && kittens + cats >= 3) { counts += count_at(FRIENDLY_TRIS + p); }
+                if(!friendly && kittens >= 3) { counts += count_at(KITTEN_TRIS + p); }
+                if(!friendly && cats >= 3) { counts += count_at(CAT_TRIS + p); }
+            }
+            table.counts[friendly * CORNER_STATES + index] = counts;
+        }
+    }
+    return table;
+}
+
+constexpr Line_Table LINE_TABLE = make_line_table();
+constexpr Corner_Table CORNER_TABLE = make_corner_table();
+
+/// WINDOWS
+static inline void place(Pattern_Windows& windows, const Square_Deltas& deltas) {
+    for(int w = 0; w < Pattern_Windows::LINE_SLOTS; ++w) { windows.lines[w] += deltas.lines[w]; }
+    for(int w = 0; w < Pattern_Windows::CORNERS; ++w) { windows.corners[w] += deltas.corners[w]; }
+}
+
+static inline void take_off(Pattern_Windows& windows, const Square_Deltas& deltas) {
+    for(int w = 0; w < Pattern_Windows::LINE_SLOTS; ++w) { windows.lines[w] -= deltas.lines[w]; }
+    for(int w = 0; w < Pattern_Windows::CORNERS; ++w) { windows.corners[w] -= deltas.corners[w]; }
+}
+
+void Pattern_Evaluator::refresh(const Position& position, Pattern_Windows& windows) {
+    for(int w = 0; w < Pattern_Windows::LINE_SLOTS; ++w) { windows.lines[w] = w < Pattern_Windows::LINES ? LAYOUT.lines[w].base : 0; }
+    for(int w = 0; w < Pattern_Windows::CORNERS; ++w) { windows.corners[w] = LAYOUT.corners[w].base; }
+    for(int t = 1; t <= 4; ++t) {
+        for(uint64_t bits = position.pieces_of((Boop_Types::PieceType) t); bits != 0; bits &= bits - 1) {
+            place(windows, DELTAS.of[t - 1][__builtin_ctzll(bits)]);
+        }
+    }
+}
+
+void Pattern_Evaluator::update(const Pattern_Windows& before, Pattern_Windows& after, const Position& position, const Position::Undo& undo) {
+    after = before;
+    for(int t = 1; t <= 4; ++t) {
+        uint64_t now = position.pieces_of((Boop_Types::PieceType) t);
+        for(uint64_t bits = undo.changed[t - 1] & now; bits != 0; bits &= bits - 1) { place(after, DELTAS.of[t - 1][__builtin_ctzll(bits)]); }
+        for(uint64_t bits = undo.changed[t - 1] & ~now; bits != 0; bits &= bits - 1) { take_off(after, DELTAS.of[t - 1][__builtin_ctzll(bits)]); }
+    }
+}
+
+/// EVALUATION
+Eval_Features Pattern_Evaluator::features(const Position& position, const Pattern_Windows& windows) {
+    Eval_Features f;
+    Evaluator::material_features(position, f);
+
+    uint64_t lines = 0;
+    for(int w = 0; w < Pattern_Windows::LINES; ++w) { lines += LINE_TABLE.counts[windows.lines[w]]; }
+    uint64_t corners = 0;
+    for(int w = 0; w < Pattern_Windows::CORNERS; ++w) { corners += CORNER_TABLE.counts[windows.corners[w]]; }
+
+    auto count = [](uint64_t counts, int byte) { return (int) (counts >> (8 * byte) & 0xFF); };
+    for(int p = 0; p < 2; ++p) {
+        f.kitten_pairs[p] = count(lines, KITTEN_PAIRS + p);
+        f.kitten_threes[p] = count(lines, KITTEN_THREES + p);
+        f.cat_pairs[p] = count(lines, CAT_PAIRS + p);
+        f.cat_threes[p] = count(lines, CAT_THREES + p) > 0;
+        f.cat_tris[p] = count(corners, CAT_TRIS + p);
+        f.kitten_tris[p] = count(corners, KITTEN_TRIS + p);
+    }
+    f.friendly_tris = count(corners, FRIENDLY_TRIS + (f.next_mover == Boop_Types::P1 ? 0 : 1));
+    return f;
+}
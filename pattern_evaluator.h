@@ -0,0 +1,66 @@
+/**
+*    @file: pattern_evaluator.h
+*   @brief: The shared evaluation computed from lookup tables instead of board scans. Every length 3 line and
+*           every 3x3 corner window of the board is listed once at compile time, and the contents of each
+*           window are packed into an index, one base 5 digit per square. A table indexed by it holds the
+*           window's share of the pattern counts (pairs, threes and tris for both players) packed one per
+*           byte, so summing the table entries of every window gives all the counts at once. The indexes
+*           are kept up to date as squares change, so an evaluation is a fixed run of lookups and adds.
+*
+*           The counts match Evaluator::features exactly, so the score is the same for the same weights.
+*
+*/
+
+#ifndef PATTERN_EVALUATOR_H
+#define PATTERN_EVALUATOR_H
+
+#include "evaluator.h"
+#include "position.h"
+#include <cstdint>
+
+// The index of every window, the state of the board as the pattern evaluator sees it
+struct Pattern_Windows {
+    static const int LINES = 84;        // 80 length 3 lines, and the 4 diagonals only 2 squares long
+    static const int LINE_SLOTS = 96;   // Padded with empty windows to a whole number of vectors
+    static const int CORNERS = 32;      // 16 windows for the tris of one piece type, 16 for the player to move's tris
+    alignas(16) uint8_t lines[LINE_SLOTS];
+    alignas(16) uint16_t corners[CORNERS];
+};
+
+class Pattern_Evaluator {
+    public:
+        explicit Pattern_Evaluator(const Eval_Weights& weights = Eval_Weights()) : evaluator(weights) { }
+
+        /**
+         * @brief Computes the window indexes of a position from scratch
+        */
+        static void refresh(const Position& position, Pattern_Windows& windows);
+
+        /**
+         * @brief Works out the window indexes after a move from the ones before it
+         * @param before The windows of the position before the move
+         * @param after Filled in with the windows of the position after it
+         * @param position The position after the move
+         * @param undo What the move changed, as returned by Position::make_move
+        */
+        static void update(const Pattern_Windows& before, Pattern_Windows& after, const Position& position, const Position::Undo& undo);
+
+        /**
+         * @brief Collects the same counts as Evaluator::features, the patterns from the window tables
+         * @param windows The windows of the position, from refresh or update
+        */
+        static Eval_Features features(const Position& position, const Pattern_Windows& windows);
+
+        /**
+         * @brief Scores a position
+         * @return Negative if P1 is winning and positive if P2 is winning
+        */
+        int evaluate(const Position& position, const Pattern_Windows& windows) const { return evaluator.score(features(position, windows)); }
+
+        const Eval_Weights& get_weights() const { return evaluator.get_weights(); }
+
+    private:
+        Evaluator evaluator;
+};
+
+#endif
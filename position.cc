@@ -0,0 +1,475 @@
+/**
+*    @file: position.cc
+*   @brief: The Boop rules, acting on the plain game state in a Position
+*
+*/
+
+#include "position.h"
+#include "bitboard.h"
+#include "evaluator.h"
+#include "symmetry.h"
+#include <cassert>
+using namespace std;
+using namespace bitboard;
+
+/// BITBOARD HELPERS
+// Square (x, y) is bit (y * SIZE + x), see Position::pieces
+int square(int x, int y) { return y * Position::SIZE + x; }
+
+/// ZOBRIST HASHING
+// Random keys XORed into the hash, one for each piece type on each square, each reserve count,
+// each move state, and one for P2 being the player to move
+struct Zobrist_Keys {
+    uint64_t piece[4][Position::SIZE * Position::SIZE];
+    uint64_t reserve[4][9];
+    uint64_t move_state[3];
+    uint64_t P2_to_move;
+};
+
+constexpr uint64_t splitmix64(uint64_t& seed) {
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Zobrist_Keys make_zobrist_keys() {
+    Zobrist_Keys keys = {};
+    uint64_t seed = 0x426F6F70; // "Boop"
+    for(auto& type : keys.piece) { for(uint64_t& k : type) { k = splitmix64(seed); } }
+    for(auto& type : keys.reserve) { for(uint64_t& k : type) { k = splitmix64(seed); } }
+    for(uint64_t& k : keys.move_state) { k = splitmix64(seed); }
+    keys.P2_to_move = splitmix64(seed);
+    return keys;
+}
+
+constexpr Zobrist_Keys ZOBRIST = make_zobrist_keys();
+
+/// PUBLIC FUNCTIONS
+Position::Position() {
+    key = compute_key();
+}
+
+Position::Position(const uint64_t pieces[4], const int8_t reserve[4], MoveState move_state, int move_number)
+    : move_state(move_state), move_number(move_number) {
+    for(int i = 0; i < 4; ++i) {
+        this->pieces[i] = pieces[i];
+        this->reserve[i] = reserve[i];
+    }
+    key = compute_key();
+}
+
+Position::Undo Position::make_move(Move move) {
+    Undo undo;
+    undo.move = move;
+    undo.move_state = move_state;
+    undo.key = key;
+    int before_move_number = move_number;
+    for(int i = 0; i < 4; ++i) {
+        undo.changed[i] = pieces[i];
+        undo.reserve_change[i] = reserve[i];
+    }
+
+    apply_move(move);
+
+    undo.turn_ended = move_number != before_move_number;
+    for(int i = 0; i < 4; ++i) {
+        undo.changed[i] ^= pieces[i];
+        undo.reserve_change[i] = reserve[i] - undo.reserve_change[i];
+    }
+#ifdef BOOP_DEBUG_HASH
+    assert(key == compute_key());
+#endif
+    return undo;
+}
+
+void Position::unmake_move(const Undo& undo) {
+    for(int i = 0; i < 4; ++i) {
+        pieces[i] ^= undo.changed[i];
+        reserve[i] -= undo.reserve_change[i];
+    }
+    move_state = undo.move_state;
+    if(undo.turn_ended) { move_number--; }
+    key = undo.key;
+}
+
+uint64_t Position::compute_key() const {
+    uint64_t hash = 0;
+    for(int i = 0; i < 4; ++i) {
+        for(uint64_t left = pieces[i]; left != 0; left &= left - 1) {
+            hash ^= ZOBRIST.piece[i][__builtin_ctzll(left)];
+        }
+        hash ^= ZOBRIST.reserve[i][reserve[i]];
+    }
+    hash ^= ZOBRIST.move_state[move_state];
+    if(next_mover() == P2) { hash ^= ZOBRIST.P2_to_move; }
+    return hash;
+}
+
+/// SYMMETRY
+Position Position::transformed(int symmetry) const {
+    Position turned = *this;
+    for(int i = 0; i < 4; ++i) { turned.pieces[i] = symmetry::bitboard(symmetry, pieces[i]); }
+    turned.key = turned.compute_key();
+    return turned;
+}
+
+uint64_t Position::canonical_key(int* symmetry) const {
+    // Everything but the pieces hashes the same in every transform, so only the piece keys are redone
+    uint64_t keys[symmetry::COUNT];
+    uint64_t board = 0;
+    for(int i = 0; i < 4; ++i) {
+        for(uint64_t left = pieces[i]; left != 0; left &= left - 1) { board ^= ZOBRIST.piece[i][__builtin_ctzll(left)]; }
+    }
+    for(uint64_t& k : keys) { k = key ^ board; }
+    for(int i = 0; i < 4; ++i) {
+        for(uint64_t left = pieces[i]; left != 0; left &= left - 1) {
+            int sq = __builtin_ctzll(left);
+            for(int t = 0; t < symmetry::COUNT; ++t) { keys[t] ^= ZOBRIST.piece[i][symmetry::square(t, sq)]; }
+        }
+    }
+
+    int smallest = 0;
+    for(int t = 1; t < symmetry::COUNT; ++t) {
+        if(keys[t] < keys[smallest]) { smallest = t; }
+    }
+    if(symmetry != nullptr) { *symmetry = smallest; }
+    return keys[smallest];
+}
+
+int Position::symmetries() const {
+    int mask = 1;
+    for(int t = 1; t < symmetry::COUNT; ++t) {
+        bool same = true;
+        for(int i = 0; i < 4 && same; ++i) { same = symmetry::bitboard(t, pieces[i]) == pieces[i]; }
+        if(same) { mask |= 1 << t; }
+    }
+    return mask;
+}
+
+void Position::drop_symmetric_moves(MoveList& moves) const {
+    int mask = symmetries();
+    if(mask == 1) { return; }
+
+    bool kept[Move::INDEX_COUNT] = {};
+    MoveList unique;
+    for(Move move : moves) {
+        bool duplicate = false;
+        for(int t = 1; t < symmetry::COUNT && !duplicate; ++t) {
+            if(mask >> t & 1) { duplicate = kept[symmetry::move(t, move).index()]; }
+        }
+        if(duplicate) { continue; }
+        kept[move.index()] = true;
+        unique.push(move);
+    }
+    moves = unique;
+}
+
+void Position::apply_move(Move move) {
+    int move_y = -1;
+    int move_x = -1;
+
+
+    /// If move_state == MAKE_MOVE
+    if(move_state == MAKE_MOVE) {     
+        char type  = move.cat() ? 'r' : 'b';
+        move_y = move.y();
+        move_x = move.x();
+
+        /// Add piece to board / Subtract piece from reserve
+        PieceType placed;
+        if(next_mover() == P1) { // P1
+            placed = type == 'b' ? P1_KIT : P1_CAT;
+        } else { // P2
+            placed = type == 'b' ? P2_KIT : P2_CAT;
+        }
+        toggle_piece(placed, square(move_x, move_y));
+        add_to_reserve(placed, -1);
+        
+        /// Boop adjacent pieces
+        boop_adjacent_pieces(type, move_x, move_y);
+        /// Check for three in a row (for CURRENT player only)
+        /// If current player makes three in row for opponent, the opponent starts turn by placing a piece, THEN removes three
+        if(has_three_in_row(friends())) {
+            set_move_state(REMOVE_THREE);
+            return;
+        }
+        /// Check for no remaining bunnies or rabbits
+        if(kittens(next_mover()) == 0 && cats(next_mover()) == 0) {
+            set_move_state(REMOVE_ONE);
+            return;
+        }
+    } else if (move_state == REMOVE_THREE) {
+        /// Remove pieces and add rabbits to reserve.
+        for(int i = 0; i < 3; ++i) {
+            move_y = move.square(i) / SIZE;
+            move_x = move.square(i) % SIZE;
+
+            return_piece(move_x, move_y, true);
+        }
+
+    } else if (move_state == REMOVE_ONE) {
+        /// Remove the piece and add it to their pool
+        move_y = move.y();
+        move_x = move.x();
+
+        return_piece(move_x, move_y, true);
+    }
+    
+    set_move_state(MAKE_MOVE);
+    move_number++;
+    key ^= ZOBRIST.P2_to_move; // The player to move always flips
+}
+
+void Position::clone_board(Position::PieceType board[][SIZE]) const {
+    for(int y = 0; y < SIZE; ++y) {
+        for(int x = 0; x < SIZE; ++x) {
+            board[x][y] = piece_at(x, y);
+        }
+    }
+}
+
+void Position::compute_moves(MoveList& moves) const {
+    if(is_game_over()) { return; }
+
+    if (move_state == MAKE_MOVE) {
+        // Bunnies first and then rabbits, each in square order (a1, a2, ..., f6)
+        uint64_t empty = ~occupied() & ALL_SQUARES;
+        for(int i = 0; i < 2; ++i) {
+            if(i == 0 ? kittens(next_mover()) <= 0 : cats(next_mover()) <= 0) { continue; }
+            for(uint64_t open = empty; open != 0; open &= open - 1) {
+                moves.push(Move::place(__builtin_ctzll(open), i == 1));
+            }
+        }
+    } else if (move_state == REMOVE_THREE) {
+        uint64_t mine = friends();
+        uint64_t east  = mine & look<1, 0>(mine) & on_board_after(2, 0); // Only (x+1, y) has to be friendly
+        uint64_t south_east = mine & look<1, -1>(mine) & look<2, -2>(mine);
+        uint64_t south = mine & look<0, -1>(mine) & look<0, -2>(mine);
+        uint64_t south_west = mine & look<-1, -1>(mine) & look<-2, -2>(mine);
+
+        for(uint64_t left = mine; left != 0; left &= left - 1) {
+            int sq = __builtin_ctzll(left);
+            uint64_t bit = 1ULL << sq;
+
+            if(east & bit)       { moves.push(Move::remove_three(sq, Move::EAST)); }       // Check E
+            if(south_east & bit) { moves.push(Move::remove_three(sq, Move::SOUTH_EAST)); } // Check SE
+            if(south & bit)      { moves.push(Move::remove_three(sq, Move::SOUTH)); }      // Check S
+            if(south_west & bit) { moves.push(Move::remove_three(sq, Move::SOUTH_WEST)); } // Check SW
+        }
+    } else if (move_state == REMOVE_ONE) {
+        for(uint64_t left = friends(); left != 0; left &= left - 1) {
+            moves.push(Move::remove_one(__builtin_ctzll(left))); // Add all squares with our pieces on them be possible moves
+        }
+    }
+}
+
+bool Position::is_game_over() const {
+    return has_three_in_row(pieces[P1_CAT - 1]) || has_three_in_row(pieces[P2_CAT - 1]) ||
+            has_eight_cat_down(P1) || has_eight_cat_down(P2);
+}
+
+bool Position::is_legal(Move move) const {
+    // Check bounds
+    if(!move.on_board()) { return false; }
+
+    if (move_state == MAKE_MOVE) {
+        if(move.kind() != Move::PLACE) { return false; }
+
+        // Check if player has enough
+        if(!move.cat() && kittens(next_mover()) <= 0) { return false; }
+        if(move.cat() && cats(next_mover()) <= 0) { return false; }
+
+        // Check if space is occupied
+        if(piece_at(move.x(), move.y()) != NONE) { return false; }
+        
+    } else if (move_state == REMOVE_THREE) {
+        // The move encoding only describes straight lines, so each piece just has to be friendly
+        if(move.kind() != Move::REMOVE_THREE) { return false; }
+        for(int i = 0; i < 3; ++i) {
+            if(!is_friend(move.square(i) % SIZE, move.square(i) / SIZE)) { return false; }
+        }
+
+    } else if (move_state == REMOVE_ONE) {
+        if(move.kind() != Move::REMOVE_ONE) { return false; }
+        if(!is_friend(move.x(), move.y())) { return false; }
+    }
+    return true;
+}
+
+// Returns the type of the piece at (x, y)
+Position::PieceType Position::piece_at(int x, int y) const {
+    uint64_t bit = 1ULL << square(x, y);
+    for(int i = 0; i < 4; ++i) {
+        if(pieces[i] & bit) { return (PieceType) (i + 1); }
+    }
+    return NONE;
+}
+
+bool Position::is_friend(int x, int y) const {
+    return in_bounds(x, y) && (friends() >> square(x, y) & 1);
+}
+
+bool Position::has_eight_cat_down(who player) const {
+    if(kittens(player) != 0 || cats(player) != 0) { return false; }
+
+    return pieces[(player == P1 ? P1_KIT : P2_KIT) - 1] == 0;
+}
+
+int Position::count_type_in_row(int len_of_row, PieceType type) const {
+    // If we are in NONE mode, then we see if friendly pieces are in a row
+    uint64_t mine = (type == NONE ? friends() : pieces[type - 1]);
+    if(len_of_row < 2) { return 0; }
+
+    // Each run keeps the squares that start a row, walking one more square out on each loop
+    uint64_t east = mine, south_east = mine, south = mine, south_west = mine;
+    uint64_t east_walk = mine, south_east_walk = mine, south_walk = mine, south_west_walk = mine;
+    for(int i = 1; i < len_of_row; ++i) {
+        east_walk       = look<1, 0>(east_walk);        // Count E
+        south_east_walk = look<1, -1>(south_east_walk); // Count SE
+        south_walk      = look<0, -1>(south_walk);      // Count S
+        south_west_walk = look<-1, -1>(south_west_walk);// Count SW
+        east &= east_walk;
+        south_east &= south_east_walk;
+        south &= south_walk;
+        south_west &= south_west_walk;
+    }
+    return popcount(east) + popcount(south_east) + popcount(south) + popcount(south_west);
+}
+
+int Position::count_tri_pattern(PieceType type) const {
+    // If we are in NONE mode, then we look for friendly pieces
+    return type == NONE ? count_friendly_tri_pattern(friends()) : bitboard::count_tri_pattern(pieces[type - 1]);
+}
+
+int Position::tactical_gain(Move move) const {
+    int own_kit = (next_mover() == P1 ? P1_KIT : P2_KIT) - 1;
+
+    if(move_state == REMOVE_THREE) { // Every bunny taken off comes back as a rabbit
+        int promoted = 0;
+        for(int i = 0; i < 3; ++i) { promoted += pieces[own_kit] >> move.square(i) & 1; }
+        return promoted;
+    }
+    if(move_state == REMOVE_ONE) { return pieces[own_kit] >> move.square() & 1; }
+
+    // Placements, judged on the board before the boop so pieces that get pushed around are ignored
+    uint64_t bit = 1ULL << move.square();
+    uint64_t mine = friends();
+    uint64_t theirs = occupied() & ~mine;
+    uint64_t own_cats = pieces[own_kit + 1];
+    int gain = 0;
+
+    if(move.cat() && has_three_in_row(own_cats | bit)) {
+        gain += 1000; // Wins the game
+    } else if(has_three_in_row(mine | bit) && !has_three_in_row(mine)) {
+        gain += 100;  // Lines up three to take off
+    }
+
+    // Rabbits can push everything, bunnies can only push bunnies
+    uint64_t boopable = move.cat() ? theirs : theirs & (pieces[P1_KIT - 1] | pieces[P2_KIT - 1]);
+    return gain + count_booped_off(bit, boopable);
+}
+
+int Position::evaluate() const {
+    static const Evaluator evaluator(Eval_Weights::boop());
+    return evaluator.evaluate(*this);
+}
+
+
+/// PRIVATE HELPER FUNCTIONS
+
+// Returns the bitboard of every piece owned by the player to move
+uint64_t Position::friends() const {
+    return next_mover() == P1 ? (pieces[P1_KIT - 1] | pieces[P1_CAT - 1]) : (pieces[P2_KIT - 1] | pieces[P2_CAT - 1]);
+}
+
+// Returns the bitboard of every piece on the board
+uint64_t Position::occupied() const {
+    return pieces[0] | pieces[1] | pieces[2] | pieces[3];
+}
+
+// Flips a piece of the given type on or off a square, keeping the hash up to date
+void Position::toggle_piece(PieceType type, int square) {
+    pieces[type - 1] ^= 1ULL << square;
+    key ^= ZOBRIST.piece[type - 1][square];
+}
+
+// Adds (or with a negative count, takes) pieces of a type to its owners reserve, keeping the hash up to date
+void Position::add_to_reserve(PieceType type, int count) {
+    key ^= ZOBRIST.reserve[type - 1][reserve[type - 1]];
+    reserve[type - 1] += count;
+    key ^= ZOBRIST.reserve[type - 1][reserve[type - 1]];
+}
+
+void Position::set_move_state(MoveState state) {
+    key ^= ZOBRIST.move_state[move_state] ^ ZOBRIST.move_state[state];
+    move_state = state;
+}
+
+// Returns a piece at (x, y) to the players pool, and promotes it if desired
+void Position::return_piece(int x, int y, bool promote) {
+    PieceType type = piece_at(x, y);
+    if(type == NONE) { return; }
+
+    toggle_piece(type, square(x, y)); // Empty the square
+    switch(type) {
+        case P1_KIT:
+            add_to_reserve(promote ? P1_CAT : P1_KIT, 1);
+            break;
+        case P2_KIT:
+            add_to_reserve(promote ? P2_CAT : P2_KIT, 1);
+            break;
+        default: // Rabbits go back as rabbits
+            add_to_reserve(type, 1);
+            break;
+    }
+}
+
+// Given an origin square and type, it will move all legal pieces one space away and return them to the owners pool if they fall off
+void Position::boop_adjacent_pieces(char type, int x, int y) {
+    uint64_t origin = 1ULL << square(x, y);
+    // Rabbits can push everything, bunnies can only push bunnies
+    uint64_t boopable = (type == 'r') ? occupied() : (pieces[P1_KIT - 1] | pieces[P2_KIT - 1]);
+
+    // Each direction touches different squares, so the order they are booped in does not matter
+    boop_toward< 0,  1>(origin, boopable); // Check N
+    boop_toward< 1,  1>(origin, boopable); // Check NE
+    boop_toward< 1,  0>(origin, boopable); // Check E
+    boop_toward< 1, -1>(origin, boopable); // Check SE
+    boop_toward< 0, -1>(origin, boopable); // Check S
+    boop_toward<-1, -1>(origin, boopable); // Check SW
+    boop_toward<-1,  0>(origin, boopable); // Check W
+    boop_toward<-1,  1>(origin, boopable); // Check NW
+}
+
+// Returns how many of the targets next to the origin sit on the edge they would be booped over
+int Position::count_booped_off(uint64_t origin, uint64_t targets) const {
+    return popcount(shift< 0,  1>(origin) & targets & ~on_board_after( 0,  1)) + // N
+           popcount(shift< 1,  1>(origin) & targets & ~on_board_after( 1,  1)) + // NE
+           popcount(shift< 1,  0>(origin) & targets & ~on_board_after( 1,  0)) + // E
+           popcount(shift< 1, -1>(origin) & targets & ~on_board_after( 1, -1)) + // SE
+           popcount(shift< 0, -1>(origin) & targets & ~on_board_after( 0, -1)) + // S
+           popcount(shift<-1, -1>(origin) & targets & ~on_board_after(-1, -1)) + // SW
+           popcount(shift<-1,  0>(origin) & targets & ~on_board_after(-1,  0)) + // W
+           popcount(shift<-1,  1>(origin) & targets & ~on_board_after(-1,  1));  // NW
+}
+
+// Boops the piece next to the origin in the (DX, DY) direction, if there is one that can be pushed
+template<int DX, int DY>
+void Position::boop_toward(uint64_t origin, uint64_t boopable) {
+    uint64_t target = shift<DX, DY>(origin) & boopable;
+    if(target == 0) { return; }
+
+    uint64_t landing = shift<DX, DY>(target);
+    if(landing == 0) { // If the next square out is out of bounds
+        // return the piece to the owners reserve
+        int sq = __builtin_ctzll(target);
+        return_piece(sq % SIZE, sq / SIZE);
+    } else if((landing & occupied()) == 0) { // The next square is at least not occupied
+        // Move the boopable piece to the target square and remove it from the origin square
+        int from = __builtin_ctzll(target);
+        PieceType type = piece_at(from % SIZE, from / SIZE);
+        toggle_piece(type, from);
+        toggle_piece(type, __builtin_ctzll(landing));
+    }
+}
@@ -0,0 +1,126 @@
+/**
+*    @file: position.h
+*   @brief: The Boop game state and the rules that act on it. A Position is trivially copyable and holds
+*           nothing but the board, reserves, move state, move number and a Zobrist hash of them, so
+*           searches can copy it freely.
+*           The Boop class is the match driver that owns one, along with the AI and display settings.
+*
+*/
+
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "move.h"
+#include <cstdint>
+#include <type_traits>
+
+// Board size and enums shared by Position and the Boop match driver
+struct Boop_Types {
+    static const int SIZE = 6;
+    enum PieceType { NONE, P1_KIT, P1_CAT, P2_KIT, P2_CAT };
+    enum MoveState { MAKE_MOVE, REMOVE_THREE, REMOVE_ONE };
+    enum who { P1, NEUTRAL, P2 };
+};
+
+class Position : public Boop_Types {
+    public:
+        // Everything make_move changed, so unmake_move can put the position back exactly as it was
+        struct Undo {
+            Move move;
+            MoveState move_state;       // The move state before the move
+            bool turn_ended;            // The move finished the turn and advanced the move number
+            // Squares that changed for each piece type, indexed by (PieceType - 1). This covers the placed piece,
+            // pieces booped to a new square, pieces that fell off, removed pieces, and bunnies promoted on removal.
+            uint64_t changed[4];
+            // Pieces each reserve gained or spent, indexed by (PieceType - 1)
+            int8_t reserve_change[4];
+            uint64_t key;               // The hash before the move
+        };
+
+        static constexpr int CENTER_INCENTIVE[SIZE][SIZE] ={{ 1, 2, 4, 4, 2, 1},
+                                                            { 2, 5, 7, 7, 5, 2},
+                                                            { 4, 7,10,10, 7, 4},
+                                                            { 4, 7,10,10, 7, 4},
+                                                            { 2, 5, 7, 7, 5, 2},
+                                                            { 1, 2, 4, 4, 2, 1}};
+
+        Position();
+        // A position from its parts, as stored by a dataset, pieces and reserve indexed by (PieceType - 1)
+        Position(const uint64_t pieces[4], const int8_t reserve[4], MoveState move_state, int move_number);
+
+        // Applies a move for the current player, returning the record unmake_move needs to take it back
+        Undo make_move(Move move);
+        // Takes back the last move made, moves must be taken back in the reverse order they were made
+        void unmake_move(const Undo& undo);
+
+        int moves_completed() const { return move_number; }
+        who last_mover() const { return (move_number % 2 == 1 ? P1 : P2); }
+        who next_mover() const { return (move_number % 2 == 0 ? P1 : P2); }
+        who opposite(who player) const { return (player == P1) ? P2 : P1; }
+        who winning() const { return (evaluate() > 0 ? P2 : P1); }
+
+        void clone_board(PieceType board[][SIZE]) const;
+        void compute_moves(MoveList& moves) const;
+        bool is_game_over() const;
+        bool is_legal(Move move) const;
+        int kittens(who player) const { return reserve[(player == P1 ? P1_KIT : P2_KIT) - 1]; }
+        int cats(who player) const { return reserve[(player == P1 ? P1_CAT : P2_CAT) - 1]; }
+        MoveState move_type() const { return move_state; }
+        PieceType piece_at(int x, int y) const;
+        bool is_friend(int x, int y) const;
+        bool in_bounds(int x, int y) const { return (x < SIZE && y < SIZE && x >= 0 && y >= 0); }
+        bool has_eight_cat_down(who player) const;
+        int count_type_in_row(int len_of_row, PieceType type = NONE) const;
+        int count_tri_pattern(PieceType type = NONE) const;
+        // A quick guess at how forcing a move is, for move ordering. 0 for a quiet move.
+        int tactical_gain(Move move) const;
+
+        // Scores the position with Eval_Weights::boop(), negative if P1 is winning and positive if P2 is winning
+        int evaluate() const;
+
+        // The pieces of one type as a bitboard, square (x, y) is bit (y * SIZE + x)
+        uint64_t pieces_of(PieceType type) const { return pieces[type - 1]; }
+        // The pieces of the player to move as a bitboard
+        uint64_t friends() const;
+
+        // A 64 bit Zobrist hash of the pieces, reserves, move state and player to move, kept up to date by make_move
+        uint64_t hash() const { return key; }
+        // Recomputes the hash from scratch, it always matches hash() unless something went wrong
+        uint64_t compute_key() const;
+
+        // The position turned or mirrored by a symmetry::Transform
+        Position transformed(int symmetry) const;
+        // The smallest hash() of the 8 transforms of the position, so all 8 share it. Optionally sets
+        // symmetry to the transform with that hash.
+        uint64_t canonical_key(int* symmetry = nullptr) const;
+        // A mask with bit t set for each transform t that leaves the board as it is, bit 0 is always set
+        int symmetries() const;
+        // Drops each move that a symmetry of the position turns into a move earlier in the list, since
+        // both lead to the same game. A no op for the usual position with no symmetry.
+        void drop_symmetric_moves(MoveList& moves) const;
+
+    private:
+        // One bitboard per piece type, indexed by (PieceType - 1). Square (x, y) is bit (y * SIZE + x),
+        // the same square index a Move uses.
+        uint64_t pieces[4] = { 0, 0, 0, 0 };
+        MoveState move_state = MAKE_MOVE;
+        int move_number = 0;
+        int8_t reserve[4] = { 8, 0, 8, 0 }; // Pieces off the board, indexed by (PieceType - 1)
+        uint64_t key;
+
+        // Helper Functions
+        void apply_move(Move move);
+        void toggle_piece(PieceType type, int square);
+        void add_to_reserve(PieceType type, int count);
+        void set_move_state(MoveState state);
+        uint64_t occupied() const;
+        void return_piece(int x, int y, bool promote = false);
+        void boop_adjacent_pieces(char type, int x, int y);
+        template<int DX, int DY> void boop_toward(uint64_t origin, uint64_t boopable);
+        int count_booped_off(uint64_t origin, uint64_t targets) const;
+};
+
+static_assert(std::is_trivially_copyable<Position>::value, "Position must stay cheap to copy");
+static_assert(sizeof(Position) <= 64, "Position must fit in a cache line");
+
+#endif
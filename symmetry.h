@@ -0,0 +1,86 @@
+/**
+*    @file: symmetry.h
+*   @brief: The 8 rotations and reflections of the board. The rules treat every direction the same, so a
+*           position and its transforms play out the same way, and a cache keyed on the smallest of their
+*           hashes (Position::canonical_key) finds all 8 of them under one entry.
+*
+*/
+
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "move.h"
+#include <cstdint>
+
+namespace symmetry {
+    const int SIZE = 6;
+    const int COUNT = 8;
+    enum Transform { IDENTITY, ROTATE_90, ROTATE_180, ROTATE_270, FLIP_X, FLIP_Y, TRANSPOSE, ANTI_TRANSPOSE };
+
+    // Where transform t sends the square (x, y)
+    constexpr int transform_square(int t, int x, int y) {
+        const int last = SIZE - 1;
+        switch(t) {
+            case ROTATE_90:      return x * SIZE + (last - y);
+            case ROTATE_180:     return (last - y) * SIZE + (last - x);
+            case ROTATE_270:     return (last - x) * SIZE + y;
+            case FLIP_X:         return y * SIZE + (last - x);
+            case FLIP_Y:         return (last - y) * SIZE + x;
+            case TRANSPOSE:      return x * SIZE + y;
+            case ANTI_TRANSPOSE: return (last - x) * SIZE + (last - y);
+            default:             return y * SIZE + x;
+        }
+    }
+
+    struct Square_Table {
+        uint8_t square[COUNT][SIZE * SIZE];
+    };
+
+    constexpr Square_Table make_square_table() {
+        Square_Table table = {};
+        for(int t = 0; t < COUNT; ++t) {
+            for(int sq = 0; sq < SIZE * SIZE; ++sq) { table.square[t][sq] = transform_square(t, sq % SIZE, sq / SIZE); }
+        }
+        return table;
+    }
+
+    // SQUARES.square[t][sq] is where transform t sends square sq
+    constexpr Square_Table SQUARES = make_square_table();
+
+    // The transform that undoes t, the quarter turns undo each other and the rest undo themselves
+    inline int inverse(int t) { return t == ROTATE_90 ? ROTATE_270 : (t == ROTATE_270 ? ROTATE_90 : t); }
+
+    inline int square(int t, int sq) { return SQUARES.square[t][sq]; }
+
+    inline uint64_t bitboard(int t, uint64_t bits) {
+        uint64_t moved = 0;
+        for(; bits != 0; bits &= bits - 1) { moved |= 1ULL << SQUARES.square[t][__builtin_ctzll(bits)]; }
+        return moved;
+    }
+
+    // The same move on the transformed board. A REMOVE_THREE line may come out walking the other way,
+    // in which case it starts from its far end instead.
+    inline Move move(int t, Move move) {
+        switch(move.kind()) {
+            case Move::PLACE:      return Move::place(square(t, move.square()), move.cat());
+            case Move::REMOVE_ONE: return Move::remove_one(square(t, move.square()));
+            case Move::REMOVE_THREE: {
+                int first = square(t, move.square(0));
+                int last = square(t, move.square(2));
+                int dx = (square(t, move.square(1)) % SIZE) - first % SIZE;
+                int dy = (square(t, move.square(1)) / SIZE) - first / SIZE;
+                if(dy > 0 || (dy == 0 && dx < 0)) { // Lines always walk east or south
+                    first = last;
+                    dx = -dx;
+                    dy = -dy;
+                }
+                Move::Line line = dy == 0 ? Move::EAST : (dx == 1 ? Move::SOUTH_EAST : (dx == 0 ? Move::SOUTH : Move::SOUTH_WEST));
+                return Move::remove_three(first, line);
+            }
+            default:
+                return move;
+        }
+    }
+}
+
+#endif
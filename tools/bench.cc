@@ -0,0 +1,248 @@
+/**
+*    @file: bench.cc
+*   @brief: Times the engine hot paths one at a time over a fixed set of mid game positions, and the search
+*           speed of each AI. Every benchmark is sampled many times and reported as the median and 99th
+*           percentile cost per call, so a change can be compared against a saved run.
+*
+*           Usage: bench [-o results.json] [-b baseline.json]
+*           Results are written as JSON, and compared benchmark by benchmark against the baseline if one is given.
+*
+*/
+
+#include "../boop.h"
+#include "../AI/Minimax_Alpha_Beta_AI.h"
+#include "../AI/Pattern_AI.h"
+#include "../AI/Boopy_Alpha_Beta.h"
+#include "../AI/MCTS_AI.h"
+#include "../AI/RandomAI.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int CORPUS_SIZE = 256;
+const int SAMPLES = 101;
+const int SEARCH_POSITIONS = 8;
+const double SEARCH_THINK_MS = 25;
+const double REGRESSION_PERCENT = 5; // Slower than this against the baseline is flagged
+
+struct Result {
+    string name;
+    string unit;
+    double median;
+    double p99;
+};
+
+// A mid game position, with the moves that lead to it so a Boop can be set up for the AIs
+struct Sample_Position {
+    vector<Move> history;
+    Position position;
+    MoveList moves;
+};
+
+// Anything a benchmark computes is added here, so the compiler cannot skip the work
+volatile uint64_t sink = 0;
+
+uint64_t next_random(uint64_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+// Random games from a fixed seed, sampled between moves 10 and 40 so the board is busy
+vector<Sample_Position> make_corpus() {
+    vector<Sample_Position> corpus;
+    uint64_t rng = 0x426F6F70;
+    while((int) corpus.size() < CORPUS_SIZE) {
+        Sample_Position sample;
+        int length = 10 + next_random(rng) % 31;
+        for(int i = 0; i < length && !sample.position.is_game_over(); ++i) {
+            MoveList moves;
+            sample.position.compute_moves(moves);
+            Move move = moves[next_random(rng) % moves.size()];
+            sample.position.make_move(move);
+            sample.history.push_back(move);
+        }
+        if(sample.position.is_game_over()) { continue; }
+        sample.position.compute_moves(sample.moves);
+        corpus.push_back(sample);
+    }
+    return corpus;
+}
+
+// Runs one pass over the corpus per sample, pass returns how many calls it made
+Result measure(const string& name, const function<long long()>& pass) {
+    vector<double> costs;
+    pass(); // Warm up
+    for(int i = 0; i < SAMPLES; ++i) {
+        auto started = chrono::steady_clock::now();
+        long long calls = pass();
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - started).count();
+        costs.push_back(ns / calls);
+    }
+    sort(costs.begin(), costs.end());
+    return { name, "ns/call", costs[costs.size() / 2], costs[(costs.size() * 99 + 99) / 100 - 1] };
+}
+
+// Times think on a few positions, skipping any with a forced move, count returns the nodes (or playouts) the last think searched
+Result measure_search(const string& name, const string& unit, AI& ai, const vector<Sample_Position>& corpus, const function<long long()>& count) {
+    Random_AI opponent;
+    vector<double> costs;
+    for(int i = 0; i < SEARCH_POSITIONS; ++i) {
+        const Sample_Position& sample = corpus[i * corpus.size() / SEARCH_POSITIONS];
+        Boop game(&opponent, &ai, SEARCH_THINK_MS);
+        for(Move move : sample.history) { game.make_move(move); }
+
+        Timer timer(SEARCH_THINK_MS);
+        timer.start();
+        sink += ai.think(sample.moves, timer).raw();
+        timer.stop();
+        if(count() > 0) { costs.push_back(timer.elapsedMilliseconds() * 1e6 / count()); } // A forced move is not searched
+    }
+    sort(costs.begin(), costs.end());
+    return { name, unit, costs[costs.size() / 2], costs.back() };
+}
+
+vector<Result> run_benchmarks(vector<Sample_Position>& corpus) {
+    vector<Result> results;
+
+    results.push_back(measure("make_move", [&]() {
+        long long calls = 0;
+        for(Sample_Position& sample : corpus) {
+            for(Move move : sample.moves) {
+                Position::Undo undo = sample.position.make_move(move);
+                sink += sample.position.hash();
+                sample.position.unmake_move(undo);
+                calls++;
+            }
+        }
+        return calls;
+    }));
+    results.push_back(measure("compute_moves", [&]() {
+        for(const Sample_Position& sample : corpus) {
+            MoveList moves;
+            sample.position.compute_moves(moves);
+            sink += moves.size();
+        }
+        return (long long) corpus.size();
+    }));
+    results.push_back(measure("is_legal", [&]() {
+        long long calls = 0;
+        for(const Sample_Position& sample : corpus) {
+            for(Move move : sample.moves) {
+                sink += sample.position.is_legal(move);
+                calls++;
+            }
+        }
+        return calls;
+    }));
+    results.push_back(measure("is_game_over", [&]() {
+        for(const Sample_Position& sample : corpus) { sink += sample.position.is_game_over(); }
+        return (long long) corpus.size();
+    }));
+    results.push_back(measure("count_type_in_row", [&]() {
+        for(const Sample_Position& sample : corpus) { sink += sample.position.count_type_in_row(2, Boop::P1_KIT); }
+        return (long long) corpus.size();
+    }));
+    results.push_back(measure("count_tri_pattern", [&]() {
+        for(const Sample_Position& sample : corpus) { sink += sample.position.count_tri_pattern(Boop::P2_CAT); }
+        return (long long) corpus.size();
+    }));
+    results.push_back(measure("evaluate", [&]() {
+        for(const Sample_Position& sample : corpus) { sink += sample.position.evaluate(); }
+        return (long long) corpus.size();
+    }));
+    vector<Pattern_Windows> windows(corpus.size());
+    for(size_t i = 0; i < corpus.size(); ++i) { Pattern_Evaluator::refresh(corpus[i].position, windows[i]); }
+    const Pattern_Evaluator patterns(Eval_Weights::boop());
+    results.push_back(measure("pattern evaluate", [&]() {
+        for(size_t i = 0; i < corpus.size(); ++i) { sink += patterns.evaluate(corpus[i].position, windows[i]); }
+        return (long long) corpus.size();
+    }));
+    results.push_back(measure("copy", [&]() {
+        for(const Sample_Position& sample : corpus) {
+            Position copy = sample.position;
+            sink += copy.hash();
+        }
+        return (long long) corpus.size();
+    }));
+
+    Minimax_Alpha_Beta_AI minimax;
+    results.push_back(measure_search("search Minimax_Alpha_Beta_AI", "ns/node", minimax, corpus, [&]() { return minimax.nodes_searched(); }));
+    Pattern_AI pattern;
+    results.push_back(measure_search("search Pattern_AI", "ns/node", pattern, corpus, [&]() { return pattern.nodes_searched(); }));
+    Boopy_Alpha_Beta_AI boopy;
+    results.push_back(measure_search("search Boopy_Alpha_Beta_AI", "ns/node", boopy, corpus, [&]() { return boopy.nodes_searched(); }));
+    MCTS_AI mcts;
+    results.push_back(measure_search("search MCTS_AI", "ns/playout", mcts, corpus, [&]() { return mcts.playouts(); }));
+
+    return results;
+}
+
+void write_json(const string& path, const vector<Result>& results) {
+    ofstream out(path);
+    out << "[\n";
+    for(size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        out << "  {\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit << "\", \"median\": "
+            << result.median << ", \"p99\": " << result.p99 << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+// Reads the medians back out of a file written by write_json
+map<string, double> read_baseline(const string& path) {
+    map<string, double> medians;
+    ifstream in(path);
+    string line;
+    while(getline(in, line)) {
+        size_t name = line.find("\"name\": \"");
+        size_t median = line.find("\"median\": ");
+        if(name == string::npos || median == string::npos) { continue; }
+        name += 9;
+        medians[line.substr(name, line.find('"', name) - name)] = atof(line.c_str() + median + 10);
+    }
+    return medians;
+}
+
+int main(int argc, char* argv[]) {
+    string output = "bench.json";
+    string baseline;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-o") == 0) { output = argv[i + 1]; }
+        else if(strcmp(argv[i], "-b") == 0) { baseline = argv[i + 1]; }
+    }
+
+    vector<Sample_Position> corpus = make_corpus();
+    vector<Result> results = run_benchmarks(corpus);
+    write_json(output, results);
+
+    map<string, double> before;
+    if(!baseline.empty()) {
+        before = read_baseline(baseline);
+        if(before.empty()) { cout << "No baseline in " << baseline << ", copy " << output << " there to save one\n"; }
+    }
+
+    int regressions = 0;
+    printf("%-30s %17s %17s %10s\n", "benchmark", "median", "p99", "change");
+    for(const Result& result : results) {
+        printf("%-30s %9.1f %s %9.1f %s", result.name.c_str(), result.median, result.unit.c_str(), result.p99, result.unit.c_str());
+        auto found = before.find(result.name);
+        if(found != before.end() && found->second > 0) {
+            double change = (result.median - found->second) / found->second * 100;
+            printf(" %+9.1f%%%s", change, change > REGRESSION_PERCENT ? "  SLOWER" : "");
+            if(change > REGRESSION_PERCENT) { regressions++; }
+        }
+        printf("\n");
+    }
+    cout << "Wrote " << output << "\n";
+    return regressions == 0 ? 0 : 1;
+}
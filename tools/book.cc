@@ -0,0 +1,195 @@
+/**
+*    @file: book.cc
+*   @brief: Builds the opening book. Walks the first few plies of the game once for each player as the
+*           book side, taking only the book moves on the book side's turns and every reply on the other
+*           side's. Every book side position gets a deep search of each of its moves, and the best few
+*           moves go in the book, weighted by how close they scored to the best one. Positions are walked
+*           and stored once for all their rotations and reflections.
+*
+*           Usage: book [-p plies] [-d depth] [-t threads] [-o book.bin]
+*           The default takes several minutes on one core and splits over threads, each extra ply costs
+*           about 36 times more.
+*
+*/
+
+#include "../boop.h"
+#include "../opening_book.h"
+#include "../symmetry.h"
+#include "../AI/Minimax_Alpha_Beta_AI.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int WIN_SCORE = 1 << 20;
+const int MARGIN = 4; // Moves up to this much worse than the best one go in the book too
+
+// A position to walk, the moves that reach it and which players it is in the walk of
+struct Node {
+    vector<Move> line;
+    int book_sides = 0;         // Bit 0 for P1, bit 1 for P2
+};
+
+int side_bit(Boop::who player) { return player == Boop::P1 ? 1 : 2; }
+
+// Plays a line of moves from the start of the game
+void replay(Boop& game, const vector<Move>& line) {
+    for(Move move : line) { game.make_move(move); }
+}
+
+// Searches every move of a position and keeps the best ones
+Opening_Book::Entry analyze(const vector<Move>& line, Minimax_Alpha_Beta_AI& ai, Timer& timer) {
+    Boop root(&ai, &ai, 0);
+    replay(root, line);
+    Boop::who side = root.next_mover();
+    MoveList moves;
+    root.compute_moves(moves);
+    root.position().drop_symmetric_moves(moves);
+
+    vector<pair<int, Move>> scored;
+    for(Move move : moves) {
+        Boop game(&ai, &ai, 0);
+        replay(game, line);
+        game.make_move(move);
+
+        // Forced replies need no search
+        MoveList replies;
+        while(!game.is_game_over()) {
+            game.compute_moves(replies);
+            if(replies.size() != 1) { break; }
+            game.make_move(replies[0]);
+        }
+
+        int score;
+        if(game.is_game_over()) {
+            score = game.winning() == side ? WIN_SCORE : -WIN_SCORE;
+        } else {
+            timer.start();
+            ai.think(replies, timer);
+            timer.stop();
+            score = game.next_mover() == side ? ai.best_score() : -ai.best_score();
+        }
+        scored.push_back({ score, move });
+    }
+    stable_sort(scored.begin(), scored.end(), [](const pair<int, Move>& a, const pair<int, Move>& b) { return a.first > b.first; });
+
+    // The book holds the moves for the canonical transform of the position
+    Opening_Book::Entry entry = {};
+    int turn;
+    entry.key = root.position().canonical_key(&turn);
+    for(int i = 0; i < (int) scored.size() && i < Opening_Book::MOVES_PER_ENTRY; ++i) {
+        int behind = scored[0].first - scored[i].first;
+        if(behind > MARGIN) { break; }
+        entry.moves[i] = symmetry::move(turn, scored[i].second).raw();
+        entry.weights[i] = MARGIN + 1 - behind;
+    }
+    return entry;
+}
+
+// Analyzes the positions on several threads, each with its own AI
+vector<Opening_Book::Entry> analyze_all(const vector<const Node*>& nodes, int depth, int num_threads) {
+    vector<Opening_Book::Entry> entries(nodes.size());
+    atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        Minimax_Alpha_Beta_AI ai;
+        ai.set_max_depth(depth - 1); // Each move is one ply, the search below it the rest
+        Timer timer(1e9);
+        for(size_t i = next++; i < nodes.size(); i = next++) {
+            entries[i] = analyze(nodes[i]->line, ai, timer);
+        }
+    };
+
+    vector<thread> workers;
+    for(int i = 1; i < num_threads; ++i) { workers.emplace_back(worker); }
+    worker();
+    for(thread& t : workers) { t.join(); }
+    return entries;
+}
+
+int main(int argc, char* argv[]) {
+    int plies = 4;
+    int depth = 5;
+    int num_threads = max(1, (int) thread::hardware_concurrency());
+    string output = "book.bin";
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-p") == 0) { plies = atoi(argv[i + 1]); }
+        else if(strcmp(argv[i], "-d") == 0) { depth = atoi(argv[i + 1]); }
+        else if(strcmp(argv[i], "-t") == 0) { num_threads = max(1, atoi(argv[i + 1])); }
+        else if(strcmp(argv[i], "-o") == 0) { output = argv[i + 1]; }
+    }
+    if(depth < 2) {
+        cerr << "The search depth must be at least 2" << endl;
+        return 1;
+    }
+
+    auto started = chrono::steady_clock::now();
+    map<uint64_t, Opening_Book::Entry> book;
+    map<uint64_t, Node> level;
+    level[Position().canonical_key()] = { {}, side_bit(Boop::P1) | side_bit(Boop::P2) };
+
+    for(int ply = 0; ply < plies && !level.empty(); ++ply) {
+        // Search the positions where a book side is to move
+        vector<const Node*> to_search;
+        for(const auto& [key, node] : level) {
+            Position position;
+            for(Move move : node.line) { position.make_move(move); }
+            if(!position.is_game_over() && (node.book_sides & side_bit(position.next_mover())) && !book.count(key)) {
+                to_search.push_back(&node);
+            }
+        }
+        for(const Opening_Book::Entry& entry : analyze_all(to_search, depth, num_threads)) { book[entry.key] = entry; }
+        cout << "Ply " << ply << ": " << level.size() << " positions, " << to_search.size() << " searched, "
+             << book.size() << " in the book" << endl;
+
+        // The book side only plays its book moves, the other side plays everything
+        map<uint64_t, Node> next_level;
+        for(const auto& [key, node] : level) {
+            Position position;
+            for(Move move : node.line) { position.make_move(move); }
+            if(position.is_game_over()) { continue; }
+
+            int turn;
+            position.canonical_key(&turn);
+            MoveList moves;
+            position.compute_moves(moves);
+            position.drop_symmetric_moves(moves);
+            for(int side : { 1, 2 }) {
+                if(!(node.book_sides & side)) { continue; }
+                bool book_turn = side == side_bit(position.next_mover());
+                for(Move move : moves) {
+                    if(book_turn) {
+                        const Opening_Book::Entry& entry = book[key];
+                        uint16_t canonical = symmetry::move(turn, move).raw();
+                        if(find(entry.moves, entry.moves + Opening_Book::MOVES_PER_ENTRY, canonical) == entry.moves + Opening_Book::MOVES_PER_ENTRY) { continue; }
+                    }
+                    Position child = position;
+                    child.make_move(move);
+                    Node& next = next_level[child.canonical_key()];
+                    if(next.book_sides == 0) {
+                        next.line = node.line;
+                        next.line.push_back(move);
+                    }
+                    next.book_sides |= side;
+                }
+            }
+        }
+        level.swap(next_level);
+    }
+
+    vector<Opening_Book::Entry> entries;
+    for(const auto& [key, entry] : book) { entries.push_back(entry); }
+    if(!Opening_Book::write(output, entries)) {
+        cerr << "Could not write " << output << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << "Wrote " << entries.size() << " positions to " << output << " in " << seconds << " s" << endl;
+    return 0;
+}
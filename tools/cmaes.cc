@@ -0,0 +1,365 @@
+/**
+*    @file: cmaes.cc
+*   @brief: Searches for evaluation weights by how well they play, for the terms a fixed dataset can't fit,
+*           like the bonuses that only matter relative to the search. Each generation CMA-ES samples
+*           candidate weights around its mean, every candidate plays a short match against a reference AI
+*           with the starting weights, and the mean and covariance move toward the candidates that scored
+*           best. All the games of a generation go to one pool of threads, one game per task, and every
+*           candidate plays the same openings so their scores are compared on equal terms.
+*
+*           Usage: cmaes [-g generations] [-m games per candidate] [-d depth] [-r random plies] [-t threads]
+*                        [-w reference weights] [-c checkpoint] [-o weights]
+*           The state is saved to the checkpoint after every generation and picked up from it on the next
+*           run, and the mean so far is written as a weights file (by default cmaes.txt and cmaes_weights.txt).
+*
+*/
+
+#include "../boop.h"
+#include "../evaluator.h"
+#include "../AI/Self_Play_AI.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const double THINK_TIME = 1e9; // The search depth limits each move, not the clock
+
+using Vector = vector<double>;
+using Matrix = vector<Vector>;
+
+// Everything CMA-ES carries from one generation to the next
+struct State {
+    int generation = 0;
+    double sigma = 0.3;
+    Vector mean;
+    Vector path_sigma;
+    Vector path_c;
+    Matrix C;
+    double best_fitness = -1;
+    Vector best;
+};
+
+// Each weight is searched in units of its starting size, so big and small weights move alike
+struct Space {
+    vector<const Eval_Weights::Field*> fields;
+    Eval_Weights start;
+    Vector scale;
+
+    explicit Space(const Eval_Weights& start) : start(start) {
+        for(int i = 0; i < Eval_Weights::FIELD_COUNT; ++i) {
+            const Eval_Weights::Field& field = Eval_Weights::FIELDS[i];
+            if(field.number == nullptr || strcmp(field.name, "win") == 0) { continue; }
+            fields.push_back(&field);
+            scale.push_back(max(4, abs(start.*(field.number))));
+        }
+    }
+
+    int size() const { return fields.size(); }
+
+    Eval_Weights weights(const Vector& x) const {
+        Eval_Weights weights = start;
+        for(int i = 0; i < size(); ++i) { weights.*(fields[i]->number) = (int) lround(start.*(fields[i]->number) + x[i] * scale[i]); }
+        return weights;
+    }
+};
+
+// Symmetric eigen decomposition by Jacobi rotations, C = B diag(values) B^T, plenty fast at this size
+void eigen(Matrix A, Matrix& B, Vector& values) {
+    int n = A.size();
+    B.assign(n, Vector(n, 0));
+    for(int i = 0; i < n; ++i) { B[i][i] = 1; }
+    for(int sweep = 0; sweep < 100; ++sweep) {
+        double off = 0;
+        for(int p = 0; p < n; ++p) { for(int q = p + 1; q < n; ++q) { off += A[p][q] * A[p][q]; } }
+        if(off < 1e-22) { break; }
+        for(int p = 0; p < n; ++p) {
+            for(int q = p + 1; q < n; ++q) {
+                if(fabs(A[p][q]) < 1e-300) { continue; }
+                double theta = (A[q][q] - A[p][p]) / (2 * A[p][q]);
+                double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1);
+                double s = t * c;
+                for(int k = 0; k < n; ++k) {
+                    double kp = A[k][p], kq = A[k][q];
+                    A[k][p] = c * kp - s * kq;
+                    A[k][q] = s * kp + c * kq;
+                }
+                for(int k = 0; k < n; ++k) {
+                    double pk = A[p][k], qk = A[q][k];
+                    A[p][k] = c * pk - s * qk;
+                    A[q][k] = s * pk + c * qk;
+                }
+                for(int k = 0; k < n; ++k) {
+                    double kp = B[k][p], kq = B[k][q];
+                    B[k][p] = c * kp - s * kq;
+                    B[k][q] = s * kp + c * kq;
+                }
+            }
+        }
+    }
+    values.resize(n);
+    for(int i = 0; i < n; ++i) { values[i] = max(A[i][i], 1e-20); }
+}
+
+/// CHECKPOINTS
+bool save(const string& path, const State& state, const Space& space) {
+    // Written beside the checkpoint then moved over it, so a crash never leaves half a checkpoint
+    string temporary = path + ".tmp";
+    {
+        ofstream file(temporary);
+        file.precision(17);
+        file << "fields";
+        for(const Eval_Weights::Field* field : space.fields) { file << " " << field->name; }
+        auto write = [&](const char* name, const Vector& v) {
+            file << "\n" << name;
+            for(double x : v) { file << " " << x; }
+        };
+        file << "\ngeneration " << state.generation << "\nsigma " << state.sigma << "\nbest_fitness " << state.best_fitness;
+        write("mean", state.mean);
+        write("path_sigma", state.path_sigma);
+        write("path_c", state.path_c);
+        write("best", state.best);
+        for(const Vector& row : state.C) { write("C", row); }
+        file << "\n";
+        if(!file) { return false; }
+    }
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool load(const string& path, State& state, const Space& space) {
+    ifstream file(path);
+    if(!file) { return false; }
+    int n = space.size();
+    string name;
+    auto read = [&](Vector& v) {
+        v.resize(n);
+        for(double& x : v) { file >> x; }
+    };
+
+    file >> name;
+    for(const Eval_Weights::Field* field : space.fields) {
+        if(!(file >> name) || name != field->name) { return false; } // Saved with a different set of weights
+    }
+    state.C.clear();
+    while(file >> name) {
+        if(name == "generation") { file >> state.generation; }
+        else if(name == "sigma") { file >> state.sigma; }
+        else if(name == "best_fitness") { file >> state.best_fitness; }
+        else if(name == "mean") { read(state.mean); }
+        else if(name == "path_sigma") { read(state.path_sigma); }
+        else if(name == "path_c") { read(state.path_c); }
+        else if(name == "best") { read(state.best); }
+        else if(name == "C") {
+            state.C.emplace_back();
+            read(state.C.back());
+        } else { return false; }
+    }
+    return (int) state.C.size() == n && !file.bad();
+}
+
+/// MATCHES
+/**
+ * @brief Plays games_each games for every candidate against the reference, on a pool of threads
+ * @return The share of points each candidate took, a win is 1 and a tie 1/2
+*/
+Vector play_generation(const vector<Eval_Weights>& candidates, const Eval_Weights& reference, int games_each,
+                       int depth, int random_plies, int num_threads, uint64_t seed) {
+    int tasks = candidates.size() * games_each;
+    vector<atomic<int>> points(candidates.size()); // In half points
+    for(atomic<int>& p : points) { p = 0; }
+    atomic<int> next_task{0};
+
+    auto worker = [&]() {
+        Self_Play_AI candidate(depth, random_plies);
+        Self_Play_AI opponent(depth, random_plies);
+        opponent.set_weights(reference);
+        int loaded = -1;
+
+        for(int task = next_task++; task < tasks; task = next_task++) {
+            int c = task / games_each;
+            int game_number = task % games_each;
+            if(c != loaded) {
+                candidate.set_weights(candidates[c]);
+                loaded = c;
+            }
+
+            // Every candidate sees the same openings, and plays each one from both sides. The random
+            // moves are seeded by side, so both games of a pair open the same way.
+            uint64_t game_seed = seed + game_number / 2;
+            bool candidate_first = game_number % 2 == 0;
+            Self_Play_AI& P1 = candidate_first ? candidate : opponent;
+            Self_Play_AI& P2 = candidate_first ? opponent : candidate;
+            P1.set_seed(game_seed);
+            P2.set_seed(~game_seed);
+            Boop game(&P1, &P2, THINK_TIME);
+            Boop::who winner = game.play().winner;
+
+            if(winner == Boop::NEUTRAL) { points[c] += 1; }
+            else if((winner == Boop::P1) == candidate_first) { points[c] += 2; }
+        }
+    };
+
+    vector<thread> workers;
+    for(int i = 1; i < num_threads; ++i) { workers.emplace_back(worker); }
+    worker();
+    for(thread& t : workers) { t.join(); }
+
+    Vector fitness;
+    for(atomic<int>& p : points) { fitness.push_back(p / (2.0 * games_each)); }
+    return fitness;
+}
+
+void write_weights(const string& path, const Eval_Weights& weights) {
+    if(!weights.save(path)) { cerr << "Could not write " << path << endl; }
+}
+
+int main(int argc, char* argv[]) {
+    int generations = 50;
+    int games_each = 20;
+    int depth = 2;
+    int random_plies = 6;
+    int num_threads = max(1, (int) thread::hardware_concurrency());
+    string reference_path;
+    string checkpoint = "cmaes.txt";
+    string output = "cmaes_weights.txt";
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-g") == 0) { generations = atoi(argv[i + 1]); }
+        else if(strcmp(argv[i], "-m") == 0) { games_each = max(2, atoi(argv[i + 1]) / 2 * 2); }
+        else if(strcmp(argv[i], "-d") == 0) { depth = max(1, atoi(argv[i + 1])); }
+        else if(strcmp(argv[i], "-r") == 0) { random_plies = max(0, atoi(argv[i + 1])); }
+        else if(strcmp(argv[i], "-t") == 0) { num_threads = max(1, atoi(argv[i + 1])); }
+        else if(strcmp(argv[i], "-w") == 0) { reference_path = argv[i + 1]; }
+        else if(strcmp(argv[i], "-c") == 0) { checkpoint = argv[i + 1]; }
+        else if(strcmp(argv[i], "-o") == 0) { output = argv[i + 1]; }
+    }
+
+    Eval_Weights reference = Eval_Weights::alpha_beta();
+    if(!reference_path.empty() && !reference.load(reference_path)) {
+        cerr << "Could not read the weights in " << reference_path << endl;
+        return 1;
+    }
+    Space space(reference);
+    int n = space.size();
+
+    // The standard CMA-ES settings for n dimensions
+    int lambda = 4 + (int) (3 * log(n));
+    int mu = lambda / 2;
+    Vector recombination(mu);
+    for(int i = 0; i < mu; ++i) { recombination[i] = log(mu + 0.5) - log(i + 1.0); }
+    double total = 0, squares = 0;
+    for(double w : recombination) { total += w; }
+    for(double& w : recombination) { w /= total; squares += w * w; }
+    double mu_eff = 1 / squares;
+    double c_c = (4 + mu_eff / n) / (n + 4 + 2 * mu_eff / n);
+    double c_sigma = (mu_eff + 2) / (n + mu_eff + 5);
+    double c_1 = 2 / ((n + 1.3) * (n + 1.3) + mu_eff);
+    double c_mu = min(1 - c_1, 2 * (mu_eff - 2 + 1 / mu_eff) / ((n + 2) * (n + 2) + mu_eff));
+    double damping = 1 + 2 * max(0.0, sqrt((mu_eff - 1) / (n + 1)) - 1) + c_sigma;
+    double expected_norm = sqrt(n) * (1 - 1.0 / (4 * n) + 1.0 / (21.0 * n * n));
+
+    State state;
+    if(load(checkpoint, state, space)) {
+        cout << "Carrying on from generation " << state.generation << " in " << checkpoint << endl;
+    } else {
+        state.mean.assign(n, 0);
+        state.path_sigma.assign(n, 0);
+        state.path_c.assign(n, 0);
+        state.C.assign(n, Vector(n, 0));
+        for(int i = 0; i < n; ++i) { state.C[i][i] = 1; }
+        state.best = state.mean;
+    }
+    mt19937_64 random(chrono::steady_clock::now().time_since_epoch().count());
+    normal_distribution<double> normal;
+
+    for(int g = 0; g < generations; ++g) {
+        auto started = chrono::steady_clock::now();
+        Matrix B;
+        Vector D;
+        eigen(state.C, B, D);
+        for(double& d : D) { d = sqrt(d); }
+
+        // Sample the candidates, y ~ N(0, C) and x = mean + sigma * y
+        Matrix ys(lambda, Vector(n)), xs(lambda, Vector(n));
+        vector<Eval_Weights> candidates;
+        for(int k = 0; k < lambda; ++k) {
+            Vector z(n);
+            for(double& v : z) { v = normal(random); }
+            for(int i = 0; i < n; ++i) {
+                double y = 0;
+                for(int j = 0; j < n; ++j) { y += B[i][j] * D[j] * z[j]; }
+                ys[k][i] = y;
+                xs[k][i] = state.mean[i] + state.sigma * y;
+            }
+            candidates.push_back(space.weights(xs[k]));
+        }
+
+        Vector fitness = play_generation(candidates, reference, games_each, depth, random_plies, num_threads, random());
+        vector<int> order(lambda);
+        for(int k = 0; k < lambda; ++k) { order[k] = k; }
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return fitness[a] > fitness[b]; });
+        if(fitness[order[0]] > state.best_fitness) {
+            state.best_fitness = fitness[order[0]];
+            state.best = xs[order[0]];
+        }
+
+        // Move the mean toward the best candidates
+        Vector y_w(n, 0);
+        for(int r = 0; r < mu; ++r) {
+            for(int i = 0; i < n; ++i) { y_w[i] += recombination[r] * ys[order[r]][i]; }
+        }
+        for(int i = 0; i < n; ++i) { state.mean[i] += state.sigma * y_w[i]; }
+
+        // The step size path follows C^(-1/2) y_w, how far the mean moved in units of the distribution
+        Vector whitened(n, 0);
+        for(int j = 0; j < n; ++j) {
+            double projection = 0;
+            for(int i = 0; i < n; ++i) { projection += B[i][j] * y_w[i]; }
+            projection /= D[j];
+            for(int i = 0; i < n; ++i) { whitened[i] += B[i][j] * projection; }
+        }
+        double path_norm = 0;
+        for(int i = 0; i < n; ++i) {
+            state.path_sigma[i] = (1 - c_sigma) * state.path_sigma[i] + sqrt(c_sigma * (2 - c_sigma) * mu_eff) * whitened[i];
+            path_norm += state.path_sigma[i] * state.path_sigma[i];
+        }
+        path_norm = sqrt(path_norm);
+        bool h_sigma = path_norm / sqrt(1 - pow(1 - c_sigma, 2.0 * (state.generation + 1))) / expected_norm < 1.4 + 2.0 / (n + 1);
+        for(int i = 0; i < n; ++i) {
+            state.path_c[i] = (1 - c_c) * state.path_c[i] + (h_sigma ? sqrt(c_c * (2 - c_c) * mu_eff) : 0) * y_w[i];
+        }
+
+        // Rank one update from the path, rank mu update from the best candidates
+        for(int i = 0; i < n; ++i) {
+            for(int j = 0; j < n; ++j) {
+                double rank_mu = 0;
+                for(int r = 0; r < mu; ++r) { rank_mu += recombination[r] * ys[order[r]][i] * ys[order[r]][j]; }
+                double rank_one = state.path_c[i] * state.path_c[j] + (h_sigma ? 0 : c_c * (2 - c_c) * state.C[i][j]);
+                state.C[i][j] = (1 - c_1 - c_mu) * state.C[i][j] + c_1 * rank_one + c_mu * rank_mu;
+            }
+        }
+        state.sigma *= exp((c_sigma / damping) * (path_norm / expected_norm - 1));
+        state.generation++;
+
+        if(!save(checkpoint, state, space)) { cerr << "Could not write the checkpoint " << checkpoint << endl; }
+        write_weights(output, space.weights(state.mean));
+
+        double mean_fitness = 0;
+        for(double f : fitness) { mean_fitness += f; }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        cout << "Generation " << state.generation << " | Best: " << fitness[order[0]] * 100 << "% | Average: "
+             << mean_fitness / lambda * 100 << "% | Sigma: " << state.sigma << " | " << lambda * games_each << " games in "
+             << seconds << " s" << endl;
+    }
+
+    write_weights(output + ".best", space.weights(state.best));
+    cout << "Best candidate scored " << state.best_fitness * 100 << "%, written to " << output << ".best" << endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+*    @file: games.cc
+*   @brief: Reads a game file written by Boop::play. By default prints every game as text, one line per
+*           game for its players and result and then its moves, each with the time it took and the score
+*           the mover reported. With -s it only sums the file up, which also times how fast it reads.
+*
+*           Usage: games [-s] [games.bin]
+*           A move is printed as "bc4 12.3ms +45", without a score when the AI did not report one.
+*
+*/
+
+#include "../game_record.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+using namespace std;
+
+const char* winner_name(int winner) {
+    return winner == 0 ? "P1" : (winner == 2 ? "P2" : "Tie");
+}
+
+void print_game(long long index, const Game_Reader::Game& game) {
+    cout << "Game " << index << " | seed " << game.seed << " | " << game.P1_name() << " vs " << game.P2_name()
+         << " | " << game.think_time << " ms | " << game.size() << " moves | Winner: " << winner_name(game.winner) << "\n";
+    for(int i = 0; i < game.size(); ++i) {
+        cout << "  " << (i + 1) << ". " << game.move(i).to_string() << " " << game.think_ms(i) << "ms";
+        if(game.score(i) != Game_Record::NO_SCORE) { cout << " " << (game.score(i) > 0 ? "+" : "") << game.score(i); }
+        cout << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool summary = false;
+    string path = "games.bin";
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "-s") == 0) { summary = true; }
+        else { path = argv[i]; }
+    }
+
+    Game_Reader reader;
+    if(!reader.open(path)) {
+        cerr << "Could not read " << path << endl;
+        return 1;
+    }
+
+    auto started = chrono::steady_clock::now();
+    long long games = 0;
+    long long moves = 0;
+    long long scored = 0;
+    map<string, int[3]> results; // Wins as P1, ties and wins as P2, by matchup
+    Game_Reader::Game game;
+    while(reader.next(game)) {
+        games++;
+        if(!summary) {
+            print_game(games, game);
+            continue;
+        }
+
+        moves += game.size();
+        for(int i = 0; i < game.size(); ++i) {
+            if(game.score(i) != Game_Record::NO_SCORE) { scored++; }
+        }
+        results[game.P1_name() + " vs " + game.P2_name()][game.winner > 2 ? 1 : game.winner]++;
+    }
+    if(!summary) { return 0; }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << games << " games, " << moves << " moves, " << scored << " with scores\n";
+    for(const auto& [matchup, wins] : results) {
+        cout << "  " << matchup << " | P1: " << wins[0] << " | P2: " << wins[2] << " | Ties: " << wins[1] << "\n";
+    }
+    cout << "Read in " << seconds * 1000 << " ms (" << (seconds > 0 ? games / seconds : 0) << " games/s)\n";
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**
+*    @file: perft.cc
+*   @brief: Counts the leaf nodes of the game tree to a fixed depth, to measure raw move generation and
+*           make_move speed and to check that engine changes still produce exactly the same tree.
+*           Every move counts as a ply, including REMOVE_THREE and REMOVE_ONE moves.
+*
+*           Usage: perft <depth> [moves]       Counts the leaves below the position after the moves
+*                  perft <depth> [moves] -d    Also prints the count below each root move (divide)
+*                  perft -v                    Checks the stored reference counts
+*           Moves are comma separated, in the form the AIs log them (e.g., "bd6,bb4,be4,f4 f5 f6").
+*
+*/
+
+#include "../position.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+using namespace std;
+
+struct Reference {
+    const char* moves;
+    int depth;
+    unsigned long long nodes;
+};
+
+// Counted with the original string and array engine, so every later engine must match
+const char* const OPENING = "bd6,bb4,be4,ba6,bc2,bb2,ba2,bf5,bf3,be3,ba4,bd2,be1"; // Next move can make a three
+const char* const REMOVALS = "bd6,bb4,be4,ba6,bc2,bb2,ba2,bf5,bf3,be3,ba4,bd2,be1,bc5,f4 f5 f6,be5,a3 a4 a5,rd5,rc5,be3"; // P2 runs out
+const char* const MIDGAME = "bd3,bd1,bc3,bd2,ba2,bb5,ba3,bf3,bc5,bd6,bc1,bd2,bb1,bc6,bd4,bd5,bc4,bd6,be1,b2,bb6,ra2,"
+                            "a3 a4 a5,bd5,bb1,ba6,re2,be6,rb5,bc2,bb2,bf1,ba3,be5,bf5,a2,bc2,rb1,bc3,bd6";
+
+const Reference REFERENCES[] = {
+    { "", 1, 36 },
+    { "", 2, 1260 },
+    { "", 3, 42900 },
+    { "", 4, 1421952 },
+    { OPENING, 1, 25 },
+    { OPENING, 2, 491 },
+    { OPENING, 3, 11694 },
+    { OPENING, 4, 206589 },
+    { REMOVALS, 3, 15887 },
+    { REMOVALS, 4, 512193 },
+    { MIDGAME, 3, 1018 },
+    { MIDGAME, 4, 26874 },
+};
+
+// Counts the leaves depth plies below the position
+unsigned long long perft(Position& position, int depth) {
+    if(depth == 0) { return 1; }
+
+    // Every leaf is made too, so the count times make_move as well as move generation
+    MoveList moves;
+    position.compute_moves(moves);
+    unsigned long long nodes = 0;
+    for(Move move : moves) {
+        Position::Undo undo = position.make_move(move);
+        nodes += perft(position, depth - 1);
+        position.unmake_move(undo);
+    }
+    return nodes;
+}
+
+// Plays a comma separated list of moves from the start, returning false if one is not generated.
+// compute_moves is the reference here, it is what the tree is made of.
+bool play_moves(Position& position, const string& list) {
+    size_t start = 0;
+    while(start < list.size()) {
+        size_t end = list.find(',', start);
+        if(end == string::npos) { end = list.size(); }
+        Move move = Move::from_string(list.substr(start, end - start));
+        MoveList moves;
+        position.compute_moves(moves);
+        bool generated = false;
+        for(Move legal : moves) { generated = generated || legal == move; }
+        if(!generated) {
+            cerr << "Illegal move: " << list.substr(start, end - start) << endl;
+            return false;
+        }
+        position.make_move(move);
+        start = end + 1;
+    }
+    return true;
+}
+
+// Times a count and prints it with the nodes per second
+unsigned long long timed_perft(Position& position, int depth, bool divide) {
+    auto started = chrono::steady_clock::now();
+    unsigned long long nodes = 0;
+
+    if(divide) {
+        MoveList moves;
+        position.compute_moves(moves);
+        for(Move move : moves) {
+            Position::Undo undo = position.make_move(move);
+            unsigned long long count = perft(position, depth - 1);
+            position.unmake_move(undo);
+            cout << move.to_string() << ": " << count << endl;
+            nodes += count;
+        }
+    } else {
+        nodes = perft(position, depth);
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << "Depth " << depth << ": " << nodes << " nodes in " << seconds * 1000 << " ms ("
+         << (seconds > 0 ? nodes / seconds / 1e6 : 0) << " M nodes/s)" << endl;
+    return nodes;
+}
+
+int verify() {
+    int failures = 0;
+    for(const Reference& reference : REFERENCES) {
+        Position position;
+        if(!play_moves(position, reference.moves)) { return 1; }
+        unsigned long long nodes = timed_perft(position, reference.depth, false);
+        if(nodes != reference.nodes) {
+            cout << "  MISMATCH, expected " << reference.nodes << " after \"" << reference.moves << "\"" << endl;
+            failures++;
+        }
+    }
+    cout << (failures == 0 ? "All reference counts match" : "Some reference counts do not match") << endl;
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc > 1 && strcmp(argv[1], "-v") == 0) { return verify(); }
+    if(argc < 2) {
+        cerr << "Usage: perft <depth> [moves] [-d]  or  perft -v" << endl;
+        return 1;
+    }
+
+    int depth = atoi(argv[1]);
+    string moves;
+    bool divide = false;
+    for(int i = 2; i < argc; ++i) {
+        if(strcmp(argv[i], "-d") == 0) { divide = true; }
+        else { moves = argv[i]; }
+    }
+
+    Position position;
+    if(!play_moves(position, moves)) { return 1; }
+    timed_perft(position, depth, divide);
+    return 0;
+}
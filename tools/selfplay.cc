@@ -0,0 +1,134 @@
+/**
+*    @file: selfplay.cc
+*   @brief: Generates a dataset for tuning the evaluation. Plays games between two alpha beta AIs through
+*           Boop::play on every core, each game opening with a few random moves so no two games are alike.
+*           Once a game ends its moves are replayed, and a sample of the positions the AIs searched goes to
+*           the dataset, each with the mover's search score and how the game ended for them.
+*
+*           Usage: selfplay [-g games] [-d depth] [-r random plies] [-k keep one in] [-t threads] [-a] [-o dataset.bin]
+*           -a adds to the end of an existing dataset instead of starting a new one.
+*
+*/
+
+#include "../boop.h"
+#include "../dataset.h"
+#include "../game_record.h"
+#include "../AI/Self_Play_AI.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const double THINK_TIME = 1e9; // The search depth limits each move, not the clock
+
+uint64_t next_random(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Turns each finished game into samples, called by Boop::play on the thread that played it
+class Sampler : public Game_Recorder {
+    public:
+        Sampler(Dataset_Writer& dataset, int keep_one_in, int depth) : dataset(dataset), keep_one_in(keep_one_in), depth(depth) { }
+
+        void write(const Game_Record& game) override {
+            Dataset_Sample samples[Game_Record::MAX_MOVES];
+            int count = 0;
+            uint64_t random = game.seed * 0xBF58476D1CE4E5B9ULL + 1;
+
+            Position position;
+            for(int i = 0; i < game.size(); ++i) {
+                // Forced moves and random opening moves have no score
+                int score = game.score(i);
+                if(score != Game_Record::NO_SCORE && next_random(random) % keep_one_in == 0) {
+                    int result = game.winner == Boop::NEUTRAL ? 0 : (game.winner == position.next_mover() ? 1 : -1);
+                    samples[count++] = Dataset_Sample::from(position, score, result, depth);
+                }
+                position.make_move(game.move(i));
+            }
+            dataset.write(samples, count);
+            games++;
+        }
+
+        long long games_sampled() const { return games; }
+
+    private:
+        Dataset_Writer& dataset;
+        int keep_one_in;
+        int depth;
+        atomic<long long> games{0};
+};
+
+int main(int argc, char* argv[]) {
+    int num_games = 1000;
+    int depth = 3;
+    int random_plies = 8;
+    int keep_one_in = 2;
+    int num_threads = max(1, (int) thread::hardware_concurrency());
+    bool append = false;
+    string output = "dataset.bin";
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "-a") == 0) { append = true; continue; }
+        if(i + 1 >= argc) { break; }
+        if(strcmp(argv[i], "-g") == 0) { num_games = atoi(argv[++i]); }
+        else if(strcmp(argv[i], "-d") == 0) { depth = max(1, atoi(argv[++i])); }
+        else if(strcmp(argv[i], "-r") == 0) { random_plies = max(0, atoi(argv[++i])); }
+        else if(strcmp(argv[i], "-k") == 0) { keep_one_in = max(1, atoi(argv[++i])); }
+        else if(strcmp(argv[i], "-t") == 0) { num_threads = max(1, atoi(argv[++i])); }
+        else if(strcmp(argv[i], "-o") == 0) { output = argv[++i]; }
+    }
+
+    Dataset_Writer dataset;
+    if(!dataset.open(output, append)) {
+        cerr << "Could not open " << output << (append ? " to add to it" : "") << endl;
+        return 1;
+    }
+    Sampler sampler(dataset, keep_one_in, depth);
+
+    // A new seed each run, so adding to a dataset does not play the same games again
+    uint64_t first_seed = (uint64_t) chrono::steady_clock::now().time_since_epoch().count();
+    atomic<int> next_game{0};
+    auto started = chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        Self_Play_AI P1(depth, random_plies);
+        Self_Play_AI P2(depth, random_plies);
+        Boop game(&P1, &P2, THINK_TIME);
+        game.set_recorder(&sampler, true);
+
+        for(int i = next_game++; i < num_games && !dataset.has_failed(); i = next_game++) {
+            uint64_t seed = first_seed + i;
+            P1.set_seed(seed);
+            P2.set_seed(~seed);
+            game.set_seed(seed);
+            game.play();
+
+            long long played = sampler.games_sampled();
+            if(played % 100 == 0) {
+                double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+                cout << played << " games, " << dataset.samples() << " samples, " << (long long) (dataset.samples() / seconds) << " samples/s" << endl;
+            }
+        }
+    };
+
+    vector<thread> workers;
+    for(int i = 1; i < num_threads; ++i) { workers.emplace_back(worker); }
+    worker();
+    for(thread& t : workers) { t.join(); }
+    if(!dataset.close()) {
+        cerr << "Could not write all of " << output << ", only the first " << dataset.samples() << " samples are in it" << endl;
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << "Wrote " << dataset.samples() << " samples from " << sampler.games_sampled() << " games to " << output
+         << " in " << seconds << " s" << endl;
+    return 0;
+}
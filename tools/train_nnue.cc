@@ -0,0 +1,270 @@
+/**
+*    @file: train_nnue.cc
+*   @brief: Trains the network evaluation of nnue.h on a dataset from tools/selfplay.cc and writes its weights.
+*           The network trains in floating point with the same clipped activations the integer version
+*           uses, its weights held to the ranges the integer types can store, then it is quantized with
+*           the scales in NNUE_Network. Each sample's target is how its game ended for the player to move,
+*           blended with the search score, and the loss is the squared error of the sigmoid of the output.
+*           One sample in 20 is held back to check the network on positions it did not train on.
+*
+*           Usage: train_nnue [-i dataset.bin] [-o nnue.bin] [-e epochs] [-l lambda] [-r learning rate]
+*           lambda is how much the game result counts against the search score (by default half).
+*
+*/
+
+#include "../dataset.h"
+#include "../nnue.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int INPUTS = NNUE_Network::INPUTS;
+const int HIDDEN = NNUE_Network::HIDDEN;
+const int LAYER_1 = NNUE_Network::LAYER_1;
+const int MAX_ACTIVE = NNUE_Network::SQUARES + 4;   // Pieces that can be on the board, and the four reserves
+const int BATCH = 256;
+
+// The largest weights the integer network can hold. The input weights are kept small enough that
+// every input at once can't overflow an int16 accumulator.
+const double INPUT_LIMIT = 32767.0 / NNUE_Network::ACTIVATION_SCALE / MAX_ACTIVE;
+const double WEIGHT_LIMIT = 127.0 / NNUE_Network::WEIGHT_SCALE;
+
+// The active inputs of one sample for both points of view, and what it should score
+struct Example {
+    uint8_t active[2][MAX_ACTIVE];
+    uint8_t count[2];
+    uint8_t mine;                       // The point of view of the player to move
+    float target;
+};
+
+// One block of parameters with everything Adam keeps for it
+struct Parameters {
+    vector<float> value, gradient, m, v;
+    double limit;
+
+    Parameters(size_t size, double limit) : value(size), gradient(size), m(size), v(size), limit(limit) { }
+
+    void step(double rate, int t) {
+        const double beta_1 = 0.9, beta_2 = 0.999;
+        double correction_1 = 1 - pow(beta_1, t), correction_2 = 1 - pow(beta_2, t);
+        for(size_t i = 0; i < value.size(); ++i) {
+            m[i] = beta_1 * m[i] + (1 - beta_1) * gradient[i];
+            v[i] = beta_2 * v[i] + (1 - beta_2) * gradient[i] * gradient[i];
+            value[i] -= rate * (m[i] / correction_1) / (sqrt(v[i] / correction_2) + 1e-8);
+            value[i] = min(max((double) value[i], -limit), limit);
+            gradient[i] = 0;
+        }
+    }
+};
+
+struct Float_Network {
+    Parameters input_weights{(size_t) INPUTS * HIDDEN, INPUT_LIMIT};
+    Parameters input_bias{(size_t) HIDDEN, INPUT_LIMIT};
+    Parameters layer_1_weights{(size_t) LAYER_1 * 2 * HIDDEN, WEIGHT_LIMIT};
+    Parameters layer_1_bias{(size_t) LAYER_1, 1e9};
+    Parameters output_weights{(size_t) LAYER_1, WEIGHT_LIMIT};
+    Parameters output_bias{1, 1e9};
+
+    /**
+     * @brief Runs the network on one example, and with a gradient to pass back, adds to the gradients
+     * @param output_gradient The loss gradient of the output, 0 to only run forward
+     *
+     * @return The output, in units of NNUE_Network::OUTPUT_SCALE
+    */
+    double run(const Example& example, double output_gradient = 0) {
+        float accumulator[2][HIDDEN];
+        float input[2 * HIDDEN];
+        for(int view = 0; view < 2; ++view) {
+            for(int h = 0; h < HIDDEN; ++h) { accumulator[view][h] = input_bias.value[h]; }
+            for(int i = 0; i < example.count[view]; ++i) {
+                const float* row = &input_weights.value[example.active[view][i] * HIDDEN];
+                for(int h = 0; h < HIDDEN; ++h) { accumulator[view][h] += row[h]; }
+            }
+        }
+        for(int half = 0; half < 2; ++half) {
+            int view = half == 0 ? example.mine : 1 - example.mine;
+            for(int h = 0; h < HIDDEN; ++h) { input[half * HIDDEN + h] = min(max(accumulator[view][h], 0.0f), 1.0f); }
+        }
+
+        float hidden_sum[LAYER_1], hidden[LAYER_1];
+        double output = output_bias.value[0];
+        for(int j = 0; j < LAYER_1; ++j) {
+            const float* row = &layer_1_weights.value[j * 2 * HIDDEN];
+            float sum = layer_1_bias.value[j];
+            for(int k = 0; k < 2 * HIDDEN; ++k) { sum += row[k] * input[k]; }
+            hidden_sum[j] = sum;
+            hidden[j] = min(max(sum, 0.0f), 1.0f);
+            output += output_weights.value[j] * hidden[j];
+        }
+        if(output_gradient == 0) { return output; }
+
+        // Back through the layers, the clipped activations pass a gradient only between 0 and 1
+        float input_gradient[2 * HIDDEN] = {};
+        output_bias.gradient[0] += output_gradient;
+        for(int j = 0; j < LAYER_1; ++j) {
+            output_weights.gradient[j] += output_gradient * hidden[j];
+            if(hidden_sum[j] <= 0 || hidden_sum[j] >= 1) { continue; }
+            float gradient = output_gradient * output_weights.value[j];
+            layer_1_bias.gradient[j] += gradient;
+            float* row_gradient = &layer_1_weights.gradient[j * 2 * HIDDEN];
+            const float* row = &layer_1_weights.value[j * 2 * HIDDEN];
+            for(int k = 0; k < 2 * HIDDEN; ++k) {
+                row_gradient[k] += gradient * input[k];
+                input_gradient[k] += gradient * row[k];
+            }
+        }
+        for(int half = 0; half < 2; ++half) {
+            int view = half == 0 ? example.mine : 1 - example.mine;
+            float accumulator_gradient[HIDDEN];
+            for(int h = 0; h < HIDDEN; ++h) {
+                bool passes = accumulator[view][h] > 0 && accumulator[view][h] < 1;
+                accumulator_gradient[h] = passes ? input_gradient[half * HIDDEN + h] : 0;
+                input_bias.gradient[h] += accumulator_gradient[h];
+            }
+            for(int i = 0; i < example.count[view]; ++i) {
+                float* row_gradient = &input_weights.gradient[example.active[view][i] * HIDDEN];
+                for(int h = 0; h < HIDDEN; ++h) { row_gradient[h] += accumulator_gradient[h]; }
+            }
+        }
+        return output;
+    }
+
+    void step(double rate, int t) {
+        for(Parameters* p : { &input_weights, &input_bias, &layer_1_weights, &layer_1_bias, &output_weights, &output_bias }) { p->step(rate, t); }
+    }
+
+    // Rounds the weights to the integer network's types and scales
+    void quantize(NNUE_Network& network) const {
+        const double A = NNUE_Network::ACTIVATION_SCALE, W = NNUE_Network::WEIGHT_SCALE;
+        for(int f = 0; f < INPUTS; ++f) {
+            for(int h = 0; h < HIDDEN; ++h) { network.input_weights[f][h] = (int16_t) lround(input_weights.value[f * HIDDEN + h] * A); }
+        }
+        for(int h = 0; h < HIDDEN; ++h) { network.input_bias[h] = (int16_t) lround(input_bias.value[h] * A); }
+        for(int j = 0; j < LAYER_1; ++j) {
+            for(int k = 0; k < 2 * HIDDEN; ++k) { network.layer_1_weights[j][k] = (int8_t) lround(layer_1_weights.value[j * 2 * HIDDEN + k] * W); }
+            network.layer_1_bias[j] = (int32_t) lround(layer_1_bias.value[j] * A * W);
+            network.output_weights[j] = (int8_t) lround(output_weights.value[j] * W);
+        }
+        network.output_bias = (int32_t) lround(output_bias.value[0] * A * W);
+    }
+};
+
+Example make_example(const Dataset_Sample& sample, double lambda) {
+    Example example;
+    Position position = sample.position();
+    for(int view = 0; view < 2; ++view) {
+        int count = 0;
+        for(int t = 1; t <= 4; ++t) {
+            Boop_Types::PieceType type = (Boop_Types::PieceType) t;
+            for(uint64_t bits = position.pieces_of(type); bits != 0; bits &= bits - 1) {
+                example.active[view][count++] = NNUE_Network::piece_input(view, type, __builtin_ctzll(bits));
+            }
+        }
+        example.active[view][count++] = NNUE_Network::reserve_input(view, Boop_Types::P1_KIT, position.kittens(Boop_Types::P1));
+        example.active[view][count++] = NNUE_Network::reserve_input(view, Boop_Types::P1_CAT, position.cats(Boop_Types::P1));
+        example.active[view][count++] = NNUE_Network::reserve_input(view, Boop_Types::P2_KIT, position.kittens(Boop_Types::P2));
+        example.active[view][count++] = NNUE_Network::reserve_input(view, Boop_Types::P2_CAT, position.cats(Boop_Types::P2));
+        example.count[view] = count;
+    }
+    example.mine = sample.next_mover() == Boop_Types::P1 ? 0 : 1;
+    double searched = 1 / (1 + exp(-(double) sample.score / NNUE_Network::OUTPUT_SCALE));
+    example.target = lambda * (sample.result + 1) / 2.0 + (1 - lambda) * searched;
+    return example;
+}
+
+double sigmoid(double x) { return 1 / (1 + exp(-x)); }
+
+double loss(Float_Network& network, const vector<Example>& examples, const vector<size_t>& indices) {
+    double sum = 0;
+    for(size_t i : indices) {
+        double difference = sigmoid(network.run(examples[i])) - examples[i].target;
+        sum += difference * difference;
+    }
+    return sum / max((size_t) 1, indices.size());
+}
+
+int main(int argc, char* argv[]) {
+    string input = "dataset.bin";
+    string output = "nnue.bin";
+    int epochs = 20;
+    double lambda = 0.5;
+    double rate = 0.001;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-i") == 0) { input = argv[i + 1]; }
+        else if(strcmp(argv[i], "-o") == 0) { output = argv[i + 1]; }
+        else if(strcmp(argv[i], "-e") == 0) { epochs = atoi(argv[i + 1]); }
+        else if(strcmp(argv[i], "-l") == 0) { lambda = min(1.0, max(0.0, atof(argv[i + 1]))); }
+        else if(strcmp(argv[i], "-r") == 0) { rate = atof(argv[i + 1]); }
+    }
+
+    Dataset_Reader dataset;
+    if(!dataset.open(input) || dataset.size() == 0) {
+        cerr << "Could not read a dataset from " << input << endl;
+        return 1;
+    }
+    vector<Example> examples;
+    examples.reserve(dataset.size());
+    for(const Dataset_Sample& sample : dataset) { examples.push_back(make_example(sample, lambda)); }
+
+    vector<size_t> training, validation;
+    for(size_t i = 0; i < examples.size(); ++i) { (i % 20 == 19 ? validation : training).push_back(i); }
+
+    // Small random weights, the input bias starts the accumulators inside the clipped range
+    mt19937 random(1);
+    Float_Network network;
+    auto fill = [&](Parameters& p, double spread, double offset) {
+        uniform_real_distribution<float> uniform(offset - spread, offset + spread);
+        for(float& x : p.value) { x = uniform(random); }
+    };
+    fill(network.input_weights, 0.05, 0);
+    fill(network.input_bias, 0, 0.25);
+    fill(network.layer_1_weights, 1 / sqrt(2.0 * HIDDEN), 0);
+    fill(network.layer_1_bias, 0, 0.1);
+    fill(network.output_weights, 0.5, 0);
+
+    auto started = chrono::steady_clock::now();
+    int t = 0;
+    for(int epoch = 1; epoch <= epochs; ++epoch) {
+        shuffle(training.begin(), training.end(), random);
+        for(size_t start = 0; start < training.size(); start += BATCH) {
+            size_t end = min(training.size(), start + BATCH);
+            for(size_t i = start; i < end; ++i) {
+                const Example& example = examples[training[i]];
+                // The gradient of (p - target)^2 through the sigmoid, averaged over the batch
+                double p = sigmoid(network.run(example));
+                network.run(example, 2 * (p - example.target) * p * (1 - p) / (end - start));
+            }
+            network.step(rate, ++t);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        cout << "Epoch " << epoch << " | Training loss: " << loss(network, examples, training)
+             << " | Validation loss: " << loss(network, examples, validation) << " | " << seconds << " s" << endl;
+    }
+
+    // Check the integer network against the float one it came from, on the positions themselves
+    NNUE_Network quantized;
+    network.quantize(quantized);
+    double difference = 0;
+    for(size_t i : validation) {
+        NNUE_Accumulator accumulator;
+        Position position = dataset[i].position();
+        quantized.refresh(position, accumulator);
+        double exact = network.run(examples[i]) * NNUE_Network::OUTPUT_SCALE;
+        difference += fabs(quantized.evaluate(accumulator, position.next_mover()) - exact);
+    }
+    cout << "Quantized evaluations differ by " << difference / max((size_t) 1, validation.size()) << " on average" << endl;
+
+    if(!quantized.save(output)) {
+        cerr << "Could not write " << output << endl;
+        return 1;
+    }
+    cout << "Wrote the network to " << output << endl;
+    return 0;
+}
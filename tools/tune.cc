@@ -0,0 +1,186 @@
+/**
+*    @file: tune.cc
+*   @brief: Tunes the evaluation weights against a dataset from tools/selfplay.cc, Texel style. The error is
+*           how far the sigmoid of each position's evaluation is from how its game ended (optionally blended
+*           with the search score), and the weights are nudged one at a time, keeping each change that
+*           lowers it. Every sample's features are collected once up front, so each error pass is only
+*           Evaluator::score over an array, split across every core.
+*
+*           Usage: tune [-i dataset.bin] [-w start weights] [-o weights.txt] [-e epochs] [-l lambda] [-k K] [-t threads]
+*           lambda is how much the game result counts against the search score, 1 (the default) ignores the score.
+*           K scales evaluations into the sigmoid, it is fitted to the starting weights when not given.
+*
+*/
+
+#include "../dataset.h"
+#include "../evaluator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+struct Tuning_Set {
+    vector<Eval_Features> features;
+    vector<float> targets;              // The expected result for P2, 0 is a P1 win and 1 a P2 win
+};
+
+int num_threads = 1;
+
+// Sums fn(begin, end) over the range split into a chunk per thread
+double parallel_sum(size_t size, const function<double(size_t, size_t)>& fn) {
+    vector<double> sums(num_threads, 0);
+    vector<thread> workers;
+    size_t chunk = (size + num_threads - 1) / num_threads;
+    for(int t = 0; t < num_threads; ++t) {
+        size_t begin = min(size, t * chunk);
+        size_t end = min(size, begin + chunk);
+        if(t == num_threads - 1) { sums[t] = fn(begin, end); }
+        else { workers.emplace_back([&, t, begin, end] { sums[t] = fn(begin, end); }); }
+    }
+    for(thread& worker : workers) { worker.join(); }
+    double total = 0;
+    for(double sum : sums) { total += sum; }
+    return total;
+}
+
+double sigmoid(double K, double eval) { return 1 / (1 + exp(-K * eval)); }
+
+// Collects the features of every sample, the bitboard pass done once for the whole tuning run
+Tuning_Set load(const Dataset_Reader& dataset) {
+    Tuning_Set set;
+    set.features.resize(dataset.size());
+    set.targets.resize(dataset.size());
+    parallel_sum(dataset.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) { set.features[i] = Evaluator::features(dataset[i].position()); }
+        return 0.0;
+    });
+    return set;
+}
+
+// Blends each sample's game result with its search score, which needs K to be a probability
+void set_targets(Tuning_Set& set, const Dataset_Reader& dataset, double lambda, double K) {
+    parallel_sum(dataset.size(), [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) {
+            const Dataset_Sample& sample = dataset[i];
+            double target = lambda * (sample.result + 1) / 2.0 + (1 - lambda) * sigmoid(K, sample.score);
+            set.targets[i] = sample.next_mover() == Boop_Types::P2 ? target : 1 - target; // Both are for the player to move
+        }
+        return 0.0;
+    });
+}
+
+// The mean squared error of the predictions of a set of weights
+double error(const Tuning_Set& set, const Eval_Weights& weights, double K) {
+    const Evaluator evaluator(weights);
+    double sum = parallel_sum(set.features.size(), [&](size_t begin, size_t end) {
+        double sum = 0;
+        for(size_t i = begin; i < end; ++i) {
+            double difference = set.targets[i] - sigmoid(K, evaluator.score(set.features[i]));
+            sum += difference * difference;
+        }
+        return sum;
+    });
+    return sum / max((size_t) 1, set.features.size());
+}
+
+// The K that best fits the starting weights, so the tuning only moves the weights and not their scale
+double fit_K(const Tuning_Set& set, const Eval_Weights& weights) {
+    double low = log(1e-5);
+    double high = log(1.0);
+    for(int i = 0; i < 40; ++i) {
+        double a = low + (high - low) / 3;
+        double b = high - (high - low) / 3;
+        if(error(set, weights, exp(a)) < error(set, weights, exp(b))) { high = b; }
+        else { low = a; }
+    }
+    return exp((low + high) / 2);
+}
+
+int main(int argc, char* argv[]) {
+    string input = "dataset.bin";
+    string output = "weights.txt";
+    string start;
+    int epochs = 100;
+    double lambda = 1;
+    double K = 0;
+    num_threads = max(1, (int) thread::hardware_concurrency());
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-i") == 0) { input = argv[i + 1]; }
+        else if(strcmp(argv[i], "-w") == 0) { start = argv[i + 1]; }
+        else if(strcmp(argv[i], "-o") == 0) { output = argv[i + 1]; }
+        else if(strcmp(argv[i], "-e") == 0) { epochs = atoi(argv[i + 1]); }
+        else if(strcmp(argv[i], "-l") == 0) { lambda = min(1.0, max(0.0, atof(argv[i + 1]))); }
+        else if(strcmp(argv[i], "-k") == 0) { K = atof(argv[i + 1]); }
+        else if(strcmp(argv[i], "-t") == 0) { num_threads = max(1, atoi(argv[i + 1])); }
+    }
+
+    Eval_Weights weights = Eval_Weights::alpha_beta();
+    if(!start.empty() && !weights.load(start)) {
+        cerr << "Could not read the weights in " << start << endl;
+        return 1;
+    }
+    Dataset_Reader dataset;
+    if(!dataset.open(input) || dataset.size() == 0) {
+        cerr << "Could not read a dataset from " << input << endl;
+        return 1;
+    }
+
+    auto started = chrono::steady_clock::now();
+    auto seconds = [&] { return chrono::duration<double>(chrono::steady_clock::now() - started).count(); };
+
+    // The search scores need K before they can be targets, fit it against the results alone first
+    Tuning_Set set = load(dataset);
+    set_targets(set, dataset, 1, 1);
+    if(K <= 0) { K = fit_K(set, weights); }
+    set_targets(set, dataset, lambda, K);
+    double best = error(set, weights, K);
+    cout << dataset.size() << " samples loaded in " << seconds() << " s | K: " << K << " | Error: " << best << endl;
+
+    // The win score only marks a finished game, the rest are all fair game
+    vector<const Eval_Weights::Field*> tuned;
+    for(int i = 0; i < Eval_Weights::FIELD_COUNT; ++i) {
+        const Eval_Weights::Field& field = Eval_Weights::FIELDS[i];
+        if(field.number != nullptr && strcmp(field.name, "win") != 0) { tuned.push_back(&field); }
+    }
+
+    // Big steps first, halved whenever a whole epoch finds nothing better, done when a step of 1 does not help
+    int step = 4;
+    for(int epoch = 1; epoch <= epochs; ++epoch) {
+        double epoch_started = seconds();
+        int changed = 0;
+        for(const Eval_Weights::Field* field : tuned) {
+            int original = weights.*(field->number);
+            for(int direction : { 1, -1 }) {
+                weights.*(field->number) = original + direction * step;
+                double trial = error(set, weights, K);
+                if(trial < best) {
+                    best = trial;
+                    changed++;
+                    break;
+                }
+                weights.*(field->number) = original;
+            }
+        }
+        weights.save(output);
+        cout << "Epoch " << epoch << " | Step: " << step << " | Error: " << best << " | Changed: " << changed
+             << " | " << seconds() - epoch_started << " s" << endl;
+
+        if(changed == 0) {
+            if(step == 1) { break; }
+            step /= 2;
+        }
+    }
+
+    if(!weights.save(output)) {
+        cerr << "Could not write " << output << endl;
+        return 1;
+    }
+    cout << "Wrote the weights to " << output << " after " << seconds() << " s" << endl;
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+*    @file: transposition_table.h
+*   @brief: A fixed size hash table of search results keyed on Position::hash(), so a search can reuse
+*           what it already learned about a position it reached through a different move order.
+*           Entries are packed four to a 64 byte bucket, so a probe touches a single cache line.
+*           Several search threads can share one table without locks. Each slot stores its data word and the
+*           key XORed with it, so a slot torn by two threads writing at once no longer matches either key.
+*
+*/
+
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "move.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class Transposition_Table {
+    public:
+        // How the stored score relates to the true score of the position
+        enum Bound { NO_BOUND, EXACT, LOWER, UPPER }; // LOWER: true score >= score, UPPER: true score <= score
+
+        // An unpacked copy of a slot
+        struct Entry {
+            uint64_t key = 0;
+            int32_t score = 0;
+            Move move;
+            int8_t depth = 0;
+            uint8_t bound = NO_BOUND;
+            uint8_t generation = 0;
+        };
+
+        /**
+         * @brief Creates a table using about the given amount of memory
+         * @param megabytes The table size, rounded down to a power of two number of buckets
+        */
+        explicit Transposition_Table(size_t megabytes = 16) { resize(megabytes); }
+
+        /**
+         * @brief Throws away every entry and reallocates the table
+         * @param megabytes The table size, rounded down to a power of two number of buckets
+         * @warning Not safe while a search is using the table
+        */
+        void resize(size_t megabytes) {
+            size_t count = 1;
+            while(count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) { count *= 2; }
+            buckets.reset(new Bucket[count]);
+            mask = count - 1;
+            generation = 0;
+        }
+
+        // Empties every entry without reallocating, not safe while a search is using the table
+        void clear() {
+            for(size_t i = 0; i <= mask; ++i) {
+                for(Slot& slot : buckets[i].slots) { slot.write(0, 0); }
+            }
+        }
+
+        // Call once per search, entries from older searches are the first to be replaced
+        void new_search() { generation = (generation + 1) & GENERATION_MASK; }
+
+        /**
+         * @brief Looks up a position
+         * @param key The position key
+         * @param found Filled with the stored entry when there is one
+         *
+         * @return A bool indicating if the position was in the table
+        */
+        bool probe(uint64_t key, Entry& found) const {
+            const Bucket& bucket = buckets[key & mask];
+            for(const Slot& slot : bucket.slots) {
+                Entry entry = slot.read();
+                if(entry.key == key && entry.bound != NO_BOUND) {
+                    found = entry;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Records a search result
+         * @param key The position key
+         * @param score The score the search returned
+         * @param depth The depth the position was searched to
+         * @param bound How the score relates to the true score
+         * @param move The best move found, or a NO_MOVE move if there was none
+         *
+         * @note The first three slots of a bucket keep the deepest results, the last slot always takes the newest one
+        */
+        void store(uint64_t key, int score, int depth, Bound bound, Move move) {
+            Bucket& bucket = buckets[key & mask];
+            Entry entries[ENTRIES_PER_BUCKET];
+            for(int i = 0; i < ENTRIES_PER_BUCKET; ++i) { entries[i] = bucket.slots[i].read(); }
+
+            int slot = -1;
+            for(int i = 0; i < ENTRIES_PER_BUCKET; ++i) {
+                if(entries[i].key == key && entries[i].bound != NO_BOUND) { slot = i; break; }
+            }
+            if(slot >= 0 && slot != ALWAYS_REPLACE && !replaces(entries[slot], depth, bound)) { return; }
+
+            if(slot < 0) {
+                // Pick the shallowest (or oldest) depth preferred entry, or fall back to the always replace slot
+                int shallowest = 0;
+                for(int i = 1; i < ALWAYS_REPLACE; ++i) {
+                    if(priority(entries[i]) < priority(entries[shallowest])) { shallowest = i; }
+                }
+                slot = replaces(entries[shallowest], depth, bound) ? shallowest : ALWAYS_REPLACE;
+            }
+
+            // Keep the old best move if this search did not find one
+            if(move.kind() == Move::NO_MOVE && entries[slot].key == key) { move = entries[slot].move; }
+
+            uint64_t data = (uint64_t) (uint32_t) score | (uint64_t) move.raw() << 32 |
+                            (uint64_t) (uint8_t) depth << 48 | (uint64_t) bound << 56 | (uint64_t) generation << 58;
+            bucket.slots[slot].write(key, data);
+        }
+
+    private:
+        static const int ENTRIES_PER_BUCKET = 4;
+        static const int ALWAYS_REPLACE = ENTRIES_PER_BUCKET - 1;
+        static const uint8_t GENERATION_MASK = 0x3F;
+
+        // A packed entry. The data word holds the score in bits 0-31, the move in 32-47, the depth in 48-55,
+        // the bound in 56-57 and the generation in 58-63.
+        struct Slot {
+            std::atomic<uint64_t> check{0}; // key ^ data
+            std::atomic<uint64_t> data{0};
+
+            Entry read() const {
+                uint64_t d = data.load(std::memory_order_relaxed);
+                Entry entry;
+                entry.key = check.load(std::memory_order_relaxed) ^ d;
+                entry.score = (int32_t) (uint32_t) d;
+                entry.move = Move::from_raw((uint16_t) (d >> 32));
+                entry.depth = (int8_t) (d >> 48);
+                entry.bound = d >> 56 & 3;
+                entry.generation = d >> 58 & GENERATION_MASK;
+                return entry;
+            }
+
+            void write(uint64_t key, uint64_t d) {
+                check.store(key ^ d, std::memory_order_relaxed);
+                data.store(d, std::memory_order_relaxed);
+            }
+        };
+        static_assert(sizeof(Slot) == 16, "Four slots must fill a cache line");
+
+        struct alignas(64) Bucket {
+            Slot slots[ENTRIES_PER_BUCKET];
+        };
+
+        std::unique_ptr<Bucket[]> buckets;
+        size_t mask = 0;
+        uint8_t generation = 0;
+
+        // Empty and stale entries sort first, then shallower ones
+        int priority(const Entry& entry) const {
+            if(entry.bound == NO_BOUND || entry.generation != generation) { return -1; }
+            return entry.depth;
+        }
+
+        // Depth preferred entries are only replaced by a result at least as deep, or an exact one a ply shallower
+        bool replaces(const Entry& entry, int depth, Bound bound) const {
+            if(priority(entry) < 0) { return true; }
+            return depth >= entry.depth || (bound == EXACT && depth + 1 >= entry.depth);
+        }
+};
+
+#endif